@@ -0,0 +1,75 @@
+/**
+ * @file halfsiphash.h
+ * @brief Реализация алгоритма HalfSipHash-2-4 для генерации MAC
+ *
+ * HalfSipHash - вариант SipHash на 32-битных словах (ключ 64 бита).
+ * Все сложения и повороты укладываются в одну инструкцию Cortex-M4,
+ * поэтому на 32-битном МК он заметно быстрее SipHash-2-4.
+ * Используется 64-битный выход (HalfSipHash-2-4-64).
+ */
+
+#ifndef HALFSIPHASH_H_
+#define HALFSIPHASH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Константы алгоритма */
+#define HALFSIPHASH_CROUND 2     // Кол-во раундов сжатия
+#define HALFSIPHASH_FROUND 4     // Кол-во финализирующих раундов
+#define HALFSIPHASH_KEY_SIZE 8   // Размер ключа в байтах (64 бита)
+#define HALFSIPHASH_MAC_SIZE 8   // Размер MAC в байтах (64 бита)
+
+/* Состояние потокового вычисления (без кучи, можно вести из прерывания) */
+typedef struct {
+    uint32_t v0, v1, v2, v3;   // Внутреннее состояние
+    uint32_t tail;             // Байты неполного слова (little-endian)
+    uint32_t len;              // Всего обработано байт
+} HalfSipHashContext;
+
+/**
+ * @brief Генерация 64-битного значения MAC с использованием HalfSipHash-2-4
+ *
+ * @param key Указатель на ключ (8 байт)
+ * @param data Указатель на данные
+ * @param len Длина данных в байтах
+ * @return Значение MAC (64 бита, младшие 32 бита - первая половина)
+ */
+uint64_t HalfSipHash_2_4(const uint8_t* key, const uint8_t* data, size_t len);
+
+/**
+ * @brief Генерация 64-битного значения MAC и запись в буфер
+ *
+ * @param key Указатель на ключ (8 байт)
+ * @param data Указатель на данные
+ * @param len Длина данных в байтах
+ * @param out Буфер для записи MAC (8 байт)
+ */
+void HalfSipHash_2_4_MAC(const uint8_t* key, const uint8_t* data, size_t len, uint8_t* out);
+
+/**
+ * @brief Начало потокового вычисления
+ *
+ * @param ctx Указатель на состояние
+ * @param key Указатель на ключ (8 байт)
+ */
+void HalfSipHash_Init(HalfSipHashContext* ctx, const uint8_t* key);
+
+/**
+ * @brief Добавление очередной порции данных (порции могут быть любой длины)
+ *
+ * @param ctx Указатель на состояние
+ * @param data Указатель на данные
+ * @param len Длина данных в байтах
+ */
+void HalfSipHash_Update(HalfSipHashContext* ctx, const uint8_t* data, size_t len);
+
+/**
+ * @brief Завершение вычисления, результат совпадает с HalfSipHash_2_4_MAC
+ *
+ * @param ctx Указатель на состояние
+ * @param out Буфер для записи MAC (8 байт)
+ */
+void HalfSipHash_Final(HalfSipHashContext* ctx, uint8_t* out);
+
+#endif /* HALFSIPHASH_H_ */
@@ -111,3 +111,109 @@ void SipHash_2_4_MAC(const uint8_t* key, const uint8_t* data, size_t len, uint8_
     uint64_t h = SipHash_2_4(key, data, len);
     U64TO8_LE(out, h);
 }
+
+/**
+ * @brief Сжатие последовательности полных слов
+ */
+static void siphash_compress(SipHashContext* ctx, const uint8_t* data, size_t words) {
+    uint64_t v0 = ctx->v0, v1 = ctx->v1, v2 = ctx->v2, v3 = ctx->v3;
+
+    for (size_t w = 0; w < words; w++, data += 8) {
+        uint64_t m = U8TO64_LE(data);
+        v3 ^= m;
+
+        /* Сжимающие раунды */
+        for (int i = 0; i < ctx->crounds; i++) {
+            SIPROUND;
+        }
+
+        v0 ^= m;
+    }
+
+    ctx->v0 = v0; ctx->v1 = v1; ctx->v2 = v2; ctx->v3 = v3;
+}
+
+void SipHash_Init(SipHashContext* ctx, const uint8_t* key, uint8_t crounds, uint8_t frounds) {
+    const uint64_t k0 = U8TO64_LE(key);
+    const uint64_t k1 = U8TO64_LE(key + 8);
+
+    /* Инициализация состояния и смешивание ключа */
+    ctx->v0 = 0x736f6d6570736575ULL ^ k0;
+    ctx->v1 = 0x646f72616e646f6dULL ^ k1;
+    ctx->v2 = 0x6c7967656e657261ULL ^ k0;
+    ctx->v3 = 0x7465646279746573ULL ^ k1;
+    ctx->tail = 0;
+    ctx->len = 0;
+    ctx->crounds = crounds;
+    ctx->frounds = frounds;
+}
+
+void SipHash_Update(SipHashContext* ctx, const uint8_t* data, size_t len) {
+    unsigned fill = ctx->len & 7;
+    ctx->len += len;
+
+    /* Дополняем неполное слово, оставшееся от прошлой порции */
+    if (fill != 0) {
+        while (fill < 8 && len > 0) {
+            ctx->tail |= (uint64_t)*data++ << (8 * fill++);
+            len--;
+        }
+        if (fill < 8) {
+            return;
+        }
+
+        uint8_t word[8];
+        U64TO8_LE(word, ctx->tail);
+        siphash_compress(ctx, word, 1);
+        ctx->tail = 0;
+    }
+
+    /* Полные слова - прямо из буфера данных */
+    siphash_compress(ctx, data, len / 8);
+    data += len & ~(size_t)7;
+
+    for (unsigned i = 0; i < (len & 7); i++) {
+        ctx->tail |= (uint64_t)data[i] << (8 * i);
+    }
+}
+
+void SipHash_Final(SipHashContext* ctx, uint8_t* out) {
+    uint64_t v0 = ctx->v0, v1 = ctx->v1, v2 = ctx->v2, v3 = ctx->v3;
+
+    /* Последний блок: младший байт длины и хвост сообщения */
+    uint64_t b = ((uint64_t)ctx->len << 56) | ctx->tail;
+
+    v3 ^= b;
+
+    /* Сжимающие раунды для последнего блока */
+    for (int i = 0; i < ctx->crounds; i++) {
+        SIPROUND;
+    }
+
+    v0 ^= b;
+
+    /* Финализирующие раунды */
+    v2 ^= 0xff;
+    for (int i = 0; i < ctx->frounds; i++) {
+        SIPROUND;
+    }
+
+    b = v0 ^ v1 ^ v2 ^ v3;
+    U64TO8_LE(out, b);
+}
+
+uint64_t SipHash_1_3(const uint8_t* key, const uint8_t* data, size_t len) {
+    uint8_t out[8];
+
+    SipHash_1_3_MAC(key, data, len, out);
+
+    return U8TO64_LE(out);
+}
+
+void SipHash_1_3_MAC(const uint8_t* key, const uint8_t* data, size_t len, uint8_t* out) {
+    SipHashContext ctx;
+
+    SipHash_Init(&ctx, key, SIPHASH13_CROUND, SIPHASH13_FROUND);
+    SipHash_Update(&ctx, data, len);
+    SipHash_Final(&ctx, out);
+}
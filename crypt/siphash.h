@@ -4,6 +4,10 @@
  *
  * SipHash-2-4 (2 раунда "сжатия" на каждый блок сообщения, 4 "финализирующих" раунда)
  * SipHash - быстрый короткоключевой PRF, разработанный для защиты от DoS-атак
+ *
+ * SipHash-1-3 - облегченный вариант (1 и 3 раунда), вдвое дешевле на длинных
+ * сообщениях; потоковый интерфейс SipHash_Init/Update/Final работает с любым
+ * числом раундов.
  */
 
 #ifndef SIPHASH_H_
@@ -16,6 +20,17 @@
 #define SIPHASH_CROUND 2  // Кол-во раундов сжатия
 #define SIPHASH_FROUND 4  // Кол-во финализирующих раундов
 #define SIPHASH_KEY_SIZE 16  // Размер ключа в байтах (128 бит)
+#define SIPHASH13_CROUND 1   // Кол-во раундов сжатия SipHash-1-3
+#define SIPHASH13_FROUND 3   // Кол-во финализирующих раундов SipHash-1-3
+
+/* Состояние потокового вычисления (без кучи, можно вести из прерывания) */
+typedef struct {
+    uint64_t v0, v1, v2, v3;   // Внутреннее состояние
+    uint64_t tail;             // Байты неполного слова (little-endian)
+    size_t len;                // Всего обработано байт
+    uint8_t crounds;           // Раундов сжатия на слово
+    uint8_t frounds;           // Финализирующих раундов
+} SipHashContext;
 
 /**
  * @brief Генерация 64-битного значения MAC с использованием SipHash-2-4
@@ -37,4 +52,51 @@ uint64_t SipHash_2_4(const uint8_t* key, const uint8_t* data, size_t len);
  */
 void SipHash_2_4_MAC(const uint8_t* key, const uint8_t* data, size_t len, uint8_t* out);
 
+/**
+ * @brief Генерация 64-битного значения MAC с использованием SipHash-1-3
+ *
+ * @param key Указатель на ключ (16 байт)
+ * @param data Указатель на данные
+ * @param len Длина данных в байтах
+ * @return Значение MAC (64 бита)
+ */
+uint64_t SipHash_1_3(const uint8_t* key, const uint8_t* data, size_t len);
+
+/**
+ * @brief Генерация 64-битного значения MAC SipHash-1-3 и запись в буфер
+ *
+ * @param key Указатель на ключ (16 байт)
+ * @param data Указатель на данные
+ * @param len Длина данных в байтах
+ * @param out Буфер для записи MAC (8 байт)
+ */
+void SipHash_1_3_MAC(const uint8_t* key, const uint8_t* data, size_t len, uint8_t* out);
+
+/**
+ * @brief Начало потокового вычисления
+ *
+ * @param ctx Указатель на состояние
+ * @param key Указатель на ключ (16 байт)
+ * @param crounds Раундов сжатия (2 для SipHash-2-4, 1 для SipHash-1-3)
+ * @param frounds Финализирующих раундов (4 или 3)
+ */
+void SipHash_Init(SipHashContext* ctx, const uint8_t* key, uint8_t crounds, uint8_t frounds);
+
+/**
+ * @brief Добавление очередной порции данных (порции могут быть любой длины)
+ *
+ * @param ctx Указатель на состояние
+ * @param data Указатель на данные
+ * @param len Длина данных в байтах
+ */
+void SipHash_Update(SipHashContext* ctx, const uint8_t* data, size_t len);
+
+/**
+ * @brief Завершение вычисления и запись MAC (8 байт, little-endian)
+ *
+ * @param ctx Указатель на состояние
+ * @param out Буфер для записи MAC (8 байт)
+ */
+void SipHash_Final(SipHashContext* ctx, uint8_t* out);
+
 #endif /* SIPHASH_H_ */
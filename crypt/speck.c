@@ -34,6 +34,79 @@ static void word_to_bytes(uint32_t word, uint8_t* bytes) {
     bytes[3] = (uint8_t)(word >> 24);
 }
 
+/**
+ * @brief Загрузка 32-битного слова little-endian
+ * @note На little-endian цели это один LDR (Cortex-M4 допускает и невыровненный
+ *       адрес), на остальных - сборка из байтов
+ */
+static inline uint32_t load_word(const uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+#else
+    return bytes_to_word(p);
+#endif
+}
+
+/**
+ * @brief Выгрузка 32-битного слова little-endian (один STR на little-endian цели)
+ */
+static inline void store_word(uint32_t w, uint8_t* p) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy(p, &w, sizeof(w));
+#else
+    word_to_bytes(w, p);
+#endif
+}
+
+/**
+ * @brief Загрузка 32-битного слова big-endian (порядок CBC-MAC прошивки)
+ */
+static inline uint32_t load_word_be(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/**
+ * @brief Выгрузка 32-битного слова big-endian
+ */
+static inline void store_word_be(uint32_t w, uint8_t* p) {
+    p[0] = (uint8_t)(w >> 24);
+    p[1] = (uint8_t)(w >> 16);
+    p[2] = (uint8_t)(w >> 8);
+    p[3] = (uint8_t)w;
+}
+
+/**
+ * @brief Раунды шифрования над словами блока в регистрах
+ */
+static inline void speck_encrypt_words(const SpeckContext* ctx, uint32_t* px, uint32_t* py) {
+    uint32_t x = *px, y = *py;
+
+    for (int i = 0; i < SPECK_ROUNDS; i++) {
+        x = (ROTR32(x, SPECK_ALPHA) + y) ^ ctx->round_keys[i];
+        y = ROTL32(y, SPECK_BETA) ^ x;
+    }
+
+    *px = x;
+    *py = y;
+}
+
+/**
+ * @brief Раунды расшифрования над словами блока в регистрах
+ */
+static inline void speck_decrypt_words(const SpeckContext* ctx, uint32_t* px, uint32_t* py) {
+    uint32_t x = *px, y = *py;
+
+    for (int i = SPECK_ROUNDS - 1; i >= 0; i--) {
+        y = ROTR32(y ^ x, SPECK_BETA);
+        x = ROTL32((x ^ ctx->round_keys[i]) - y, SPECK_ALPHA);
+    }
+
+    *px = x;
+    *py = y;
+}
+
 void Speck_Init(SpeckContext* ctx, const uint8_t* key) {
     uint32_t k[4]; // Ключевые слова
     uint32_t l[3]; // Вспомогательные ключевые слова
@@ -44,28 +117,22 @@ void Speck_Init(SpeckContext* ctx, const uint8_t* key) {
     l[1] = bytes_to_word(key + 8);
     l[2] = bytes_to_word(key + 12);
 
-    // Генерация ключей раундов
+    // Генерация ключей раундов: k[0] - текущий ключ раунда
     ctx->round_keys[0] = k[0];
 
     for (int i = 0; i < SPECK_ROUNDS - 1; i++) {
-        l[i % 3] = (ROTR32(l[i % 3], SPECK_ALPHA) + k[(i + 1) % 4]) ^ i;
-        k[(i + 1) % 4] = ROTL32(k[(i + 1) % 4], SPECK_BETA) ^ l[i % 3];
-        ctx->round_keys[i + 1] = k[(i + 1) % 4];
+        l[i % 3] = (ROTR32(l[i % 3], SPECK_ALPHA) + k[0]) ^ i;
+        k[0] = ROTL32(k[0], SPECK_BETA) ^ l[i % 3];
+        ctx->round_keys[i + 1] = k[0];
     }
 }
 
 void Speck_Encrypt(const SpeckContext* ctx, const uint8_t* plaintext, uint8_t* ciphertext) {
-    uint32_t x, y;
-
     // Преобразуем блок в два 32-битных слова
-    x = bytes_to_word(plaintext);
-    y = bytes_to_word(plaintext + 4);
+    uint32_t x = bytes_to_word(plaintext);
+    uint32_t y = bytes_to_word(plaintext + 4);
 
-    // Раунды шифрования
-    for (int i = 0; i < SPECK_ROUNDS; i++) {
-        x = (ROTR32(x, SPECK_ALPHA) + y) ^ ctx->round_keys[i];
-        y = ROTL32(y, SPECK_BETA) ^ x;
-    }
+    speck_encrypt_words(ctx, &x, &y);
 
     // Преобразуем обратно в байты
     word_to_bytes(x, ciphertext);
@@ -73,33 +140,17 @@ void Speck_Encrypt(const SpeckContext* ctx, const uint8_t* plaintext, uint8_t* c
 }
 
 void Speck_Decrypt(const SpeckContext* ctx, const uint8_t* ciphertext, uint8_t* plaintext) {
-    uint32_t x, y;
-
     // Преобразуем блок в два 32-битных слова
-    x = bytes_to_word(ciphertext);
-    y = bytes_to_word(ciphertext + 4);
+    uint32_t x = bytes_to_word(ciphertext);
+    uint32_t y = bytes_to_word(ciphertext + 4);
 
-    // Раунды расшифрования (в обратном порядке)
-    for (int i = SPECK_ROUNDS - 1; i >= 0; i--) {
-        y = ROTR32(y ^ x, SPECK_BETA);
-        x = ROTL32((x ^ ctx->round_keys[i]) - y, SPECK_ALPHA);
-    }
+    speck_decrypt_words(ctx, &x, &y);
 
     // Преобразуем обратно в байты
     word_to_bytes(x, plaintext);
     word_to_bytes(y, plaintext + 4);
 }
 
-/**
- * @brief Добавление дополнения PKCS#7 для блочного шифрования
- */
-static void add_pkcs7_padding(uint8_t* data, size_t data_len, size_t block_size) {
-    uint8_t padding_value = block_size - (data_len % block_size);
-    for (size_t i = 0; i < padding_value; i++) {
-        data[data_len + i] = padding_value;
-    }
-}
-
 /**
  * @brief Удаление дополнения PKCS#7 после расшифрования
  */
@@ -122,98 +173,216 @@ static size_t remove_pkcs7_padding(uint8_t* data, size_t data_len) {
     return data_len - padding_value;
 }
 
-size_t Speck_GetPaddedLength(size_t length) {
-    return length + (SPECK_BLOCK_SIZE - (length % SPECK_BLOCK_SIZE)) % SPECK_BLOCK_SIZE;
-}
+/**
+ * @brief Курсор по списку сегментов для CBC без склейки
+ */
+typedef struct {
+    const SpeckSegment* seg;
+    size_t count;
+    size_t index;            // Текущий сегмент
+    size_t offset;           // Смещение внутри текущего сегмента
+} SpeckGather;
 
-size_t Speck_CBC_Encrypt(const SpeckContext* ctx, const uint8_t* plaintext, size_t length,
-                        const uint8_t* iv, uint8_t* ciphertext) {
-    uint8_t block[SPECK_BLOCK_SIZE];
-    uint8_t chain[SPECK_BLOCK_SIZE];
-    size_t padded_length = Speck_GetPaddedLength(length);
+/**
+ * @brief Следующий блок из списка сегментов
+ *
+ * Блок, целиком лежащий в одном сегменте, читается прямо из него. Во
+ * временный буфер собирается только блок на стыке сегментов и хвост.
+ *
+ * @param g Курсор
+ * @param staging Буфер для блока на стыке (8 байт)
+ * @param block Указатель на данные блока
+ * @return Число байт в блоке: SPECK_BLOCK_SIZE, меньше - только в конце данных
+ */
+static size_t gather_block(SpeckGather* g, uint8_t* staging, const uint8_t** block) {
+    // Пустые и дочитанные сегменты пропускаем
+    while (g->index < g->count && g->offset == g->seg[g->index].length) {
+        g->index++;
+        g->offset = 0;
+    }
+    if (g->index == g->count) {
+        return 0;
+    }
 
-    // Копируем IV в цепочку
-    memcpy(chain, iv, SPECK_BLOCK_SIZE);
+    const SpeckSegment* s = &g->seg[g->index];
+    if (s->length - g->offset >= SPECK_BLOCK_SIZE) {
+        *block = s->data + g->offset;
+        g->offset += SPECK_BLOCK_SIZE;
+        return SPECK_BLOCK_SIZE;
+    }
 
-    // Шифруем полные блоки
-    size_t num_blocks = length / SPECK_BLOCK_SIZE;
-    for (size_t i = 0; i < num_blocks; i++) {
-        // XOR с предыдущим зашифрованным блоком (или IV для первого блока)
-        for (size_t j = 0; j < SPECK_BLOCK_SIZE; j++) {
-            block[j] = plaintext[i * SPECK_BLOCK_SIZE + j] ^ chain[j];
+    size_t got = 0;
+    while (got < SPECK_BLOCK_SIZE && g->index < g->count) {
+        s = &g->seg[g->index];
+        size_t take = s->length - g->offset;
+        if (take > SPECK_BLOCK_SIZE - got) {
+            take = SPECK_BLOCK_SIZE - got;
         }
 
-        // Шифруем блок
-        Speck_Encrypt(ctx, block, ciphertext + i * SPECK_BLOCK_SIZE);
+        memcpy(staging + got, s->data + g->offset, take);
+        got += take;
+        g->offset += take;
 
-        // Обновляем цепочку
-        memcpy(chain, ciphertext + i * SPECK_BLOCK_SIZE, SPECK_BLOCK_SIZE);
+        if (g->offset == s->length) {
+            g->index++;
+            g->offset = 0;
+        }
     }
 
-    // Обрабатываем последний неполный блок с дополнением
-    if (length % SPECK_BLOCK_SIZE != 0) {
-        size_t remaining = length % SPECK_BLOCK_SIZE;
+    *block = staging;
+    return got;
+}
 
-        // Копируем оставшиеся данные
-        memcpy(block, plaintext + num_blocks * SPECK_BLOCK_SIZE, remaining);
+/**
+ * @brief CBC-шифрование полных блоков, цепочка в регистрах
+ * @note in и out могут совпадать: блок читается до записи
+ */
+static void cbc_encrypt_blocks(const SpeckContext* ctx, const uint8_t* in, uint8_t* out,
+                               size_t num_blocks, uint32_t* cx, uint32_t* cy) {
+    uint32_t x = *cx, y = *cy;
+
+    for (size_t i = 0; i < num_blocks; i++) {
+        x ^= load_word(in);
+        y ^= load_word(in + 4);
+        speck_encrypt_words(ctx, &x, &y);
+        store_word(x, out);
+        store_word(y, out + 4);
+        in += SPECK_BLOCK_SIZE;
+        out += SPECK_BLOCK_SIZE;
+    }
 
-        // Добавляем дополнение PKCS#7
-        add_pkcs7_padding(block, remaining, SPECK_BLOCK_SIZE);
+    *cx = x;
+    *cy = y;
+}
 
-        // XOR с предыдущим зашифрованным блоком
-        for (size_t j = 0; j < SPECK_BLOCK_SIZE; j++) {
-            block[j] ^= chain[j];
-        }
+/**
+ * @brief CBC-расшифрование полных блоков, цепочка в регистрах
+ * @note in и out могут совпадать: шифртекст блока сохраняется до записи
+ */
+static void cbc_decrypt_blocks(const SpeckContext* ctx, const uint8_t* in, uint8_t* out,
+                               size_t num_blocks, const uint8_t* iv) {
+    uint32_t cx = load_word(iv);
+    uint32_t cy = load_word(iv + 4);
 
-        // Шифруем последний блок
-        Speck_Encrypt(ctx, block, ciphertext + num_blocks * SPECK_BLOCK_SIZE);
+    for (size_t i = 0; i < num_blocks; i++) {
+        uint32_t nx = load_word(in);
+        uint32_t ny = load_word(in + 4);
+        uint32_t x = nx, y = ny;
+
+        speck_decrypt_words(ctx, &x, &y);
+        store_word(x ^ cx, out);
+        store_word(y ^ cy, out + 4);
+
+        cx = nx;
+        cy = ny;
+        in += SPECK_BLOCK_SIZE;
+        out += SPECK_BLOCK_SIZE;
     }
-    // Если длина кратна размеру блока, добавляем дополнительный блок дополнения
-    else {
-        uint8_t padding_block[SPECK_BLOCK_SIZE];
-        // Заполняем блок значением SPECK_BLOCK_SIZE
-        memset(padding_block, SPECK_BLOCK_SIZE, SPECK_BLOCK_SIZE);
+}
 
-        // XOR с предыдущим зашифрованным блоком
-        for (size_t j = 0; j < SPECK_BLOCK_SIZE; j++) {
-            padding_block[j] ^= chain[j];
-        }
+size_t Speck_GetPaddedLength(size_t length) {
+    // PKCS#7 всегда добавляет хотя бы один байт: кратная длина дает целый блок дополнения
+    return (length / SPECK_BLOCK_SIZE + 1) * SPECK_BLOCK_SIZE;
+}
 
-        // Шифруем дополнительный блок
-        Speck_Encrypt(ctx, padding_block, ciphertext + num_blocks * SPECK_BLOCK_SIZE);
+size_t Speck_CBC_EncryptInPlace(const SpeckContext* ctx, uint8_t* data, size_t length,
+                                size_t capacity, const uint8_t* iv) {
+    size_t padded_length = Speck_GetPaddedLength(length);
+
+    if (capacity < padded_length) {
+        return 0; // Ошибка - нет места под дополнение
     }
 
+    // Дополнение PKCS#7 пишется прямо в зарезервированный хвост
+    memset(data + length, (int)(padded_length - length), padded_length - length);
+
+    uint32_t cx = load_word(iv);
+    uint32_t cy = load_word(iv + 4);
+    cbc_encrypt_blocks(ctx, data, data, padded_length / SPECK_BLOCK_SIZE, &cx, &cy);
+
     return padded_length;
 }
 
-size_t Speck_CBC_Decrypt(const SpeckContext* ctx, const uint8_t* ciphertext, size_t length,
-                        const uint8_t* iv, uint8_t* plaintext) {
-    uint8_t block[SPECK_BLOCK_SIZE];
-    uint8_t chain[SPECK_BLOCK_SIZE];
-
+size_t Speck_CBC_DecryptInPlace(const SpeckContext* ctx, uint8_t* data, size_t length,
+                                const uint8_t* iv) {
     // Проверяем, что длина кратна размеру блока
     if (length % SPECK_BLOCK_SIZE != 0 || length == 0) {
         return 0; // Ошибка - некорректная длина
     }
 
-    // Копируем IV в цепочку
-    memcpy(chain, iv, SPECK_BLOCK_SIZE);
+    cbc_decrypt_blocks(ctx, data, data, length / SPECK_BLOCK_SIZE, iv);
 
-    // Расшифровываем все блоки
-    size_t num_blocks = length / SPECK_BLOCK_SIZE;
-    for (size_t i = 0; i < num_blocks; i++) {
-        // Расшифровываем блок
-        Speck_Decrypt(ctx, ciphertext + i * SPECK_BLOCK_SIZE, block);
+    // Удаляем дополнение PKCS#7
+    return remove_pkcs7_padding(data, length);
+}
+
+size_t Speck_CBC_EncryptScatter(const SpeckContext* ctx, const SpeckSegment* segments,
+                                size_t count, const uint8_t* iv, uint8_t* ciphertext) {
+    SpeckGather g = { segments, count, 0, 0 };
+    uint8_t staging[SPECK_BLOCK_SIZE];
+    uint32_t cx = load_word(iv);
+    uint32_t cy = load_word(iv + 4);
+    size_t out = 0;
+
+    for (;;) {
+        const uint8_t* block = staging;
+        size_t n = gather_block(&g, staging, &block);
+
+        // Последний неполный (или пустой) блок добивается PKCS#7
+        if (n < SPECK_BLOCK_SIZE) {
+            memset(staging + n, (int)(SPECK_BLOCK_SIZE - n), SPECK_BLOCK_SIZE - n);
+        }
+
+        cbc_encrypt_blocks(ctx, block, ciphertext + out, 1, &cx, &cy);
+        out += SPECK_BLOCK_SIZE;
 
-        // XOR с предыдущим зашифрованным блоком (или IV для первого блока)
-        for (size_t j = 0; j < SPECK_BLOCK_SIZE; j++) {
-            plaintext[i * SPECK_BLOCK_SIZE + j] = block[j] ^ chain[j];
+        if (n < SPECK_BLOCK_SIZE) {
+            return out;
         }
+    }
+}
+
+void Speck_CBC_MAC_Scatter(const SpeckContext* ctx, const SpeckSegment* segments,
+                           size_t count, uint8_t* mac) {
+    SpeckGather g = { segments, count, 0, 0 };
+    uint8_t staging[SPECK_BLOCK_SIZE];
+    const uint8_t* block;
+    uint32_t cx = 0, cy = 0; // Нулевой IV
+    size_t n;
+
+    while ((n = gather_block(&g, staging, &block)) != 0) {
+        // Хвост дополняется нулями, как в Speck_CBC_MAC_Multi
+        if (n < SPECK_BLOCK_SIZE) {
+            memset(staging + n, 0, SPECK_BLOCK_SIZE - n);
+        }
+
+        // Слова big-endian, как speck_mac в прошивке
+        cx ^= load_word_be(block);
+        cy ^= load_word_be(block + 4);
+        speck_encrypt_words(ctx, &cx, &cy);
+    }
+
+    store_word_be(cx, mac);
+    store_word_be(cy, mac + 4);
+}
+
+size_t Speck_CBC_Encrypt(const SpeckContext* ctx, const uint8_t* plaintext, size_t length,
+                        const uint8_t* iv, uint8_t* ciphertext) {
+    // Один сегмент: полные блоки читаются из plaintext напрямую, без копии
+    SpeckSegment segment = { plaintext, length };
+
+    return Speck_CBC_EncryptScatter(ctx, &segment, 1, iv, ciphertext);
+}
 
-        // Обновляем цепочку
-        memcpy(chain, ciphertext + i * SPECK_BLOCK_SIZE, SPECK_BLOCK_SIZE);
+size_t Speck_CBC_Decrypt(const SpeckContext* ctx, const uint8_t* ciphertext, size_t length,
+                        const uint8_t* iv, uint8_t* plaintext) {
+    // Проверяем, что длина кратна размеру блока
+    if (length % SPECK_BLOCK_SIZE != 0 || length == 0) {
+        return 0; // Ошибка - некорректная длина
     }
 
+    cbc_decrypt_blocks(ctx, ciphertext, plaintext, length / SPECK_BLOCK_SIZE, iv);
+
     // Удаляем дополнение PKCS#7
     return remove_pkcs7_padding(plaintext, length);
 }
@@ -23,6 +23,12 @@ typedef struct {
     uint32_t round_keys[SPECK_ROUNDS];
 } SpeckContext;
 
+/* Фрагмент данных для CBC без предварительной склейки (заголовок, payload...) */
+typedef struct {
+    const uint8_t* data;
+    size_t length;
+} SpeckSegment;
+
 /**
  * @brief Инициализация контекста Speck c предварительной генерацией ключей раундов
  *
@@ -75,11 +81,71 @@ size_t Speck_CBC_Encrypt(const SpeckContext* ctx, const uint8_t* plaintext, size
 size_t Speck_CBC_Decrypt(const SpeckContext* ctx, const uint8_t* ciphertext, size_t length,
                         const uint8_t* iv, uint8_t* plaintext);
 
+/**
+ * @brief Шифрование в режиме CBC на месте
+ *
+ * Цепочка хранится в регистрах, XOR выполняется 32-битными словами, дополнение
+ * PKCS#7 пишется прямо в хвост буфера. Для одного LDR/STR на слово буфер
+ * лучше выравнивать на 4.
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param data Открытый текст, на выходе - шифртекст
+ * @param length Длина открытого текста в байтах
+ * @param capacity Размер буфера data, не меньше Speck_GetPaddedLength(length)
+ * @param iv Вектор инициализации (8 байт)
+ * @return Длина шифртекста в байтах (с дополнением), 0 - не хватает места
+ */
+size_t Speck_CBC_EncryptInPlace(const SpeckContext* ctx, uint8_t* data, size_t length,
+                                size_t capacity, const uint8_t* iv);
+
+/**
+ * @brief Расшифрование в режиме CBC на месте
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param data Шифртекст, на выходе - открытый текст
+ * @param length Длина шифртекста в байтах (кратна SPECK_BLOCK_SIZE)
+ * @param iv Вектор инициализации (8 байт)
+ * @return Длина открытого текста в байтах (без дополнения), 0 - некорректная длина
+ */
+size_t Speck_CBC_DecryptInPlace(const SpeckContext* ctx, uint8_t* data, size_t length,
+                                const uint8_t* iv);
+
+/**
+ * @brief Шифрование в режиме CBC набора сегментов как одного сообщения
+ *
+ * Блоки внутри сегмента читаются напрямую, копируется только блок на стыке
+ * сегментов. Шифртекст не должен перекрывать еще не прочитанные сегменты.
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param segments Массив сегментов
+ * @param count Количество сегментов
+ * @param iv Вектор инициализации (8 байт)
+ * @param ciphertext Буфер для шифртекста (Speck_GetPaddedLength от суммы длин)
+ * @return Длина шифртекста в байтах (с дополнением)
+ */
+size_t Speck_CBC_EncryptScatter(const SpeckContext* ctx, const SpeckSegment* segments,
+                                size_t count, const uint8_t* iv, uint8_t* ciphertext);
+
+/**
+ * @brief CBC-MAC (нулевой IV, дополнение нулями) набора сегментов
+ *
+ * Совпадает с CBC-MAC склеенного сообщения, но склейка не нужна. Слова
+ * блока и MAC - big-endian, как speck_mac в прошивке, чтобы хост проверял
+ * MAC фреймов.
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param segments Массив сегментов
+ * @param count Количество сегментов
+ * @param mac Буфер для MAC (8 байт)
+ */
+void Speck_CBC_MAC_Scatter(const SpeckContext* ctx, const SpeckSegment* segments,
+                           size_t count, uint8_t* mac);
+
 /**
  * @brief Вычисление размера дополненного текста
  *
  * @param length Исходная длина текста
- * @return Длина дополненного текста
+ * @return Длина дополненного текста (всегда больше length: PKCS#7)
  */
 size_t Speck_GetPaddedLength(size_t length);
 
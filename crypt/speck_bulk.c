@@ -0,0 +1,133 @@
+/**
+ * @file speck_bulk.c
+ * @brief Многопоточное расшифрование CBC на месте
+ */
+
+#include "speck_bulk.h"
+#include "speck_simd.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#define BULK_BATCH_BLOCKS  256   // Блоков за один вызов многоблочного ядра
+
+/* Задание одного потока: блоки [first, first + count) */
+typedef struct {
+    const SpeckContext* ctx;
+    uint8_t* data;
+    size_t first;
+    size_t count;
+    uint8_t prev[SPECK_BLOCK_SIZE];  // C[first - 1], сохраненный до старта потоков
+} BulkJob;
+
+/**
+ * @brief Расшифрование куска с конца: пакет D(C[a..b)) во временный буфер,
+ *        XOR с C[a-1..b-1), которые еще не перезаписаны
+ */
+static void bulk_decrypt_range(const BulkJob* job) {
+    uint8_t tmp[BULK_BATCH_BLOCKS * SPECK_BLOCK_SIZE];
+    size_t end = job->count;
+
+    while (end > 0) {
+        size_t start = (end > BULK_BATCH_BLOCKS) ? end - BULK_BATCH_BLOCKS : 0;
+        size_t n = end - start;
+        uint8_t* blocks = job->data + (job->first + start) * SPECK_BLOCK_SIZE;
+
+        Speck_DecryptBlocks(job->ctx, blocks, tmp, n);
+
+        // P[i] = D(C[i]) ^ C[i-1]; первый блок куска берет сохраненный C[first-1]
+        for (size_t j = n; j-- > 0; ) {
+            size_t index = job->first + start + j;
+            const uint8_t* chain = (start + j == 0) ? job->prev : job->data + (index - 1) * SPECK_BLOCK_SIZE;
+            uint8_t* out = blocks + j * SPECK_BLOCK_SIZE;
+
+            for (size_t k = 0; k < SPECK_BLOCK_SIZE; k++) {
+                out[k] = tmp[j * SPECK_BLOCK_SIZE + k] ^ chain[k];
+            }
+        }
+
+        end = start;
+    }
+}
+
+static void* bulk_worker(void* arg) {
+    bulk_decrypt_range((const BulkJob*)arg);
+    return NULL;
+}
+
+int Speck_CBC_DecryptBulk(const SpeckContext* ctx, uint8_t* data, size_t length,
+                         const uint8_t* iv, uint8_t* next_iv, unsigned threads) {
+    BulkJob jobs[SPECK_BULK_MAX_THREADS];
+    pthread_t tids[SPECK_BULK_MAX_THREADS];
+
+    if (length % SPECK_BLOCK_SIZE != 0) {
+        return -1;
+    }
+
+    size_t num_blocks = length / SPECK_BLOCK_SIZE;
+    if (num_blocks == 0) {
+        if (next_iv != NULL) {
+            memcpy(next_iv, iv, SPECK_BLOCK_SIZE);
+        }
+        return 0;
+    }
+
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpus > 0) ? (unsigned)cpus : 1;
+    }
+    if (threads > SPECK_BULK_MAX_THREADS) {
+        threads = SPECK_BULK_MAX_THREADS;
+    }
+    if (threads > num_blocks / SPECK_BULK_MIN_CHUNK) {
+        threads = (unsigned)(num_blocks / SPECK_BULK_MIN_CHUNK);
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    // Выбор ядра до старта потоков, чтобы они не выбирали его наперегонки
+    Speck_SIMD_Current();
+
+    size_t per_thread = num_blocks / threads;
+    size_t extra = num_blocks % threads;
+    size_t first = 0;
+
+    // Граничные блоки шифротекста сохраняем до того, как их перезапишет соседний поток
+    for (unsigned t = 0; t < threads; t++) {
+        jobs[t].ctx = ctx;
+        jobs[t].data = data;
+        jobs[t].first = first;
+        jobs[t].count = per_thread + (t < extra ? 1 : 0);
+        memcpy(jobs[t].prev, (first == 0) ? iv : data + (first - 1) * SPECK_BLOCK_SIZE, SPECK_BLOCK_SIZE);
+        first += jobs[t].count;
+    }
+
+    // next_iv может совпадать с iv, поэтому пишем его после чтения iv
+    if (next_iv != NULL) {
+        memcpy(next_iv, data + length - SPECK_BLOCK_SIZE, SPECK_BLOCK_SIZE);
+    }
+
+    // Кусок 0 обрабатывает вызывающий поток, как и куски, для которых
+    // поток не удалось создать: границы уже сохранены, порядок не важен
+    bool started[SPECK_BULK_MAX_THREADS] = { false };
+
+    for (unsigned t = 1; t < threads; t++) {
+        started[t] = (pthread_create(&tids[t], NULL, bulk_worker, &jobs[t]) == 0);
+    }
+
+    for (unsigned t = 0; t < threads; t++) {
+        if (!started[t]) {
+            bulk_decrypt_range(&jobs[t]);
+        }
+    }
+
+    for (unsigned t = 1; t < threads; t++) {
+        if (started[t]) {
+            pthread_join(tids[t], NULL);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file speck_bulk.h
+ * @brief Многопоточное расшифрование больших буферов в режиме CBC (хост)
+ *
+ * Каждый блок открытого текста зависит только от двух блоков шифротекста:
+ * P[i] = D(C[i]) ^ C[i-1], поэтому буфер делится на куски по потокам.
+ * Граничные блоки кусков сохраняются заранее, внутри куска блоки идут с конца,
+ * и C[i-1] еще не перезаписан, когда он нужен для P[i].
+ */
+
+#ifndef SPECK_BULK_H_
+#define SPECK_BULK_H_
+
+#include "speck.h"
+
+#define SPECK_BULK_MAX_THREADS   64     // Предел числа потоков
+#define SPECK_BULK_MIN_CHUNK     4096   // Меньше блоков на поток - нет смысла делить
+
+/**
+ * @brief Расшифрование CBC на месте несколькими потоками
+ *
+ * Дополнение PKCS#7 не снимается: буфер может быть фрагментом длинного потока.
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param data Шифротекст, заменяется открытым текстом
+ * @param length Длина в байтах (кратна SPECK_BLOCK_SIZE)
+ * @param iv Вектор инициализации или последний блок шифротекста предыдущего фрагмента (8 байт)
+ * @param next_iv Буфер для последнего блока шифротекста (8 байт, для следующего фрагмента) или NULL
+ * @param threads Количество потоков (0 - по числу процессоров)
+ * @return 0 при успехе, -1 при длине, не кратной размеру блока
+ */
+int Speck_CBC_DecryptBulk(const SpeckContext* ctx, uint8_t* data, size_t length,
+                         const uint8_t* iv, uint8_t* next_iv, unsigned threads);
+
+#endif /* SPECK_BULK_H_ */
@@ -0,0 +1,162 @@
+/**
+ * @file speck_cbc_tool.c
+ * @brief Утилита расшифрования записанных захватов Speck-CBC на хосте
+ *
+ * speck_cbc_tool -k <ключ, 32 hex> -i <IV, 16 hex> [-t потоки] [-p] <вход> <выход>
+ *   -p  снять дополнение PKCS#7 в конце (вход получен Speck_CBC_Encrypt)
+ *
+ * Файл читается фрагментами по SEGMENT_SIZE байт, каждый фрагмент
+ * расшифровывается на месте всеми потоками; цепочка CBC между фрагментами
+ * передается через next_iv.
+ *
+ * Сборка: cc -O2 -pthread speck_cbc_tool.c speck_bulk.c speck_simd.c speck.c
+ */
+
+#include "speck_bulk.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SEGMENT_SIZE  (64u * 1024u * 1024u)  // Размер фрагмента (кратен блоку)
+
+/**
+ * @brief Разбор строки из hex-цифр фиксированной длины
+ */
+static int parse_hex(const char* str, uint8_t* out, size_t len) {
+    if (strlen(str) != len * 2) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        unsigned int byte;
+        if (sscanf(str + 2 * i, "%2x", &byte) != 1) {
+            return -1;
+        }
+        out[i] = (uint8_t)byte;
+    }
+
+    return 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "usage: %s -k <key hex32> -i <iv hex16> [-t threads] [-p] <in> <out>\n", prog);
+}
+
+/**
+ * @brief Длина без дополнения PKCS#7 (или исходная, если дополнение некорректно)
+ */
+static size_t strip_pkcs7(const uint8_t* data, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+
+    uint8_t pad = data[len - 1];
+    if (pad == 0 || pad > SPECK_BLOCK_SIZE || pad > len) {
+        return len;
+    }
+
+    for (size_t i = len - pad; i < len; i++) {
+        if (data[i] != pad) {
+            return len;
+        }
+    }
+
+    return len - pad;
+}
+
+int main(int argc, char** argv) {
+    uint8_t key[SPECK_KEY_SIZE];
+    uint8_t iv[SPECK_BLOCK_SIZE];
+    int have_key = 0, have_iv = 0, pkcs7 = 0;
+    unsigned threads = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "k:i:t:p")) != -1) {
+        switch (opt) {
+        case 'k':
+            have_key = (parse_hex(optarg, key, sizeof(key)) == 0);
+            break;
+        case 'i':
+            have_iv = (parse_hex(optarg, iv, sizeof(iv)) == 0);
+            break;
+        case 't':
+            threads = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+        case 'p':
+            pkcs7 = 1;
+            break;
+        default:
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (!have_key || !have_iv || argc - optind != 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE* in = fopen(argv[optind], "rb");
+    FILE* out = fopen(argv[optind + 1], "wb");
+    uint8_t* buf = malloc(SEGMENT_SIZE);
+    if (in == NULL || out == NULL || buf == NULL) {
+        perror("speck_cbc_tool");
+        return 1;
+    }
+
+    SpeckContext ctx;
+    Speck_Init(&ctx, key);
+
+    size_t pending = 0;
+    int status = 0;
+
+    for (;;) {
+        size_t n = fread(buf + pending, 1, SEGMENT_SIZE - pending, in);
+        size_t total = pending + n;
+        // Заглядываем вперед: дополнение снимается только с последнего фрагмента
+        int next = fgetc(in);
+        int last = (next == EOF);
+        if (!last) {
+            ungetc(next, in);
+        }
+
+        if (total % SPECK_BLOCK_SIZE != 0 && last) {
+            fprintf(stderr, "speck_cbc_tool: input length is not a multiple of %d\n", SPECK_BLOCK_SIZE);
+            status = 1;
+            break;
+        }
+
+        // Расшифровываем все полные блоки фрагмента, остаток переносим в следующий
+        size_t whole = total - total % SPECK_BLOCK_SIZE;
+        if (Speck_CBC_DecryptBulk(&ctx, buf, whole, iv, iv, threads) != 0) {
+            status = 1;
+            break;
+        }
+
+        size_t keep = whole;
+        if (last && pkcs7) {
+            keep = strip_pkcs7(buf, whole);
+        }
+
+        if (fwrite(buf, 1, keep, out) != keep) {
+            perror("speck_cbc_tool");
+            status = 1;
+            break;
+        }
+
+        pending = total - whole;
+        memmove(buf, buf + whole, pending);
+
+        if (last) {
+            break;
+        }
+    }
+
+    free(buf);
+    fclose(in);
+    if (fclose(out) != 0) {
+        status = 1;
+    }
+    return status;
+}
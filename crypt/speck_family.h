@@ -0,0 +1,143 @@
+/**
+ * @file speck_family.h
+ * @brief Семейство шифров Speck (блоки 32/48/64/96/128 бит), генерируемое макросом
+ *
+ * SPECK_FAMILY_DEFINE разворачивает для одного варианта тип контекста
+ * и функции Init/EncryptWords/DecryptWords/Encrypt/Decrypt. Размер слова,
+ * сдвиги и число раундов - константы времени компиляции, поэтому
+ * компилятор сворачивает маски и повороты, а для 64-битных слов
+ * (Speck128) использует родные 64-битные регистры.
+ *
+ * Упаковка байтов как в speck.c: слова little-endian, x - первое слово
+ * блока, k[0] - первое слово ключа.
+ */
+
+#ifndef SPECK_FAMILY_H_
+#define SPECK_FAMILY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Генерация варианта Speck
+ *
+ * @param NAME   Префикс имен (например, Speck128_128)
+ * @param WORD   Тип, вмещающий слово (uint16_t/uint32_t/uint64_t)
+ * @param BITS   Размер слова n в битах (16, 24, 32, 48, 64)
+ * @param KWORDS Количество слов ключа m (2, 3 или 4)
+ * @param ROUNDS Количество раундов T
+ */
+#define SPECK_FAMILY_DEFINE(NAME, WORD, BITS, KWORDS, ROUNDS)                          \
+                                                                                       \
+enum {                                                                                 \
+    NAME##_BLOCK_SIZE = 2 * (BITS) / 8,                                                \
+    NAME##_KEY_SIZE = (KWORDS) * (BITS) / 8,                                           \
+    NAME##_ROUNDS = (ROUNDS)                                                           \
+};                                                                                     \
+                                                                                       \
+typedef struct {                                                                       \
+    WORD round_keys[ROUNDS];                                                           \
+} NAME##_Context;                                                                      \
+                                                                                       \
+static inline WORD NAME##_Mask(WORD v) {                                               \
+    return ((BITS) == 8 * sizeof(WORD)) ? v : (WORD)(v & (((WORD)1 << ((BITS) % (8 * sizeof(WORD)))) - 1)); \
+}                                                                                      \
+                                                                                       \
+static inline WORD NAME##_Ror(WORD v, unsigned r) {                                    \
+    return NAME##_Mask((WORD)((v >> r) | (v << ((BITS) - r))));                        \
+}                                                                                      \
+                                                                                       \
+static inline WORD NAME##_Rol(WORD v, unsigned r) {                                    \
+    return NAME##_Mask((WORD)((v << r) | (v >> ((BITS) - r))));                        \
+}                                                                                      \
+                                                                                       \
+static inline WORD NAME##_Load(const uint8_t* bytes) {                                 \
+    WORD v = 0;                                                                        \
+    for (unsigned i = 0; i < (BITS) / 8; i++) {                                        \
+        v |= (WORD)bytes[i] << (8 * i);                                                \
+    }                                                                                  \
+    return v;                                                                          \
+}                                                                                      \
+                                                                                       \
+static inline void NAME##_Store(WORD v, uint8_t* bytes) {                              \
+    for (unsigned i = 0; i < (BITS) / 8; i++) {                                        \
+        bytes[i] = (uint8_t)(v >> (8 * i));                                            \
+    }                                                                                  \
+}                                                                                      \
+                                                                                       \
+static inline void NAME##_Init(NAME##_Context* ctx, const uint8_t* key) {              \
+    WORD k = NAME##_Load(key);                                                         \
+    WORD l[(KWORDS) - 1];                                                              \
+                                                                                       \
+    for (unsigned i = 0; i < (KWORDS) - 1; i++) {                                      \
+        l[i] = NAME##_Load(key + (i + 1) * ((BITS) / 8));                              \
+    }                                                                                  \
+                                                                                       \
+    ctx->round_keys[0] = k;                                                            \
+    for (unsigned i = 0; i < (ROUNDS) - 1; i++) {                                      \
+        unsigned j = i % ((KWORDS) - 1);                                               \
+        l[j] = NAME##_Mask((WORD)((NAME##_Ror(l[j], SPECK_FAMILY_ALPHA(BITS)) + k) ^ i)); \
+        k = NAME##_Rol(k, SPECK_FAMILY_BETA(BITS)) ^ l[j];                             \
+        ctx->round_keys[i + 1] = k;                                                    \
+    }                                                                                  \
+}                                                                                      \
+                                                                                       \
+static inline void NAME##_EncryptWords(const NAME##_Context* ctx, WORD* px, WORD* py) { \
+    WORD x = *px;                                                                      \
+    WORD y = *py;                                                                      \
+                                                                                       \
+    for (unsigned i = 0; i < (ROUNDS); i++) {                                          \
+        x = NAME##_Mask((WORD)(NAME##_Ror(x, SPECK_FAMILY_ALPHA(BITS)) + y)) ^ ctx->round_keys[i]; \
+        y = NAME##_Rol(y, SPECK_FAMILY_BETA(BITS)) ^ x;                                \
+    }                                                                                  \
+                                                                                       \
+    *px = x;                                                                           \
+    *py = y;                                                                           \
+}                                                                                      \
+                                                                                       \
+static inline void NAME##_DecryptWords(const NAME##_Context* ctx, WORD* px, WORD* py) { \
+    WORD x = *px;                                                                      \
+    WORD y = *py;                                                                      \
+                                                                                       \
+    for (unsigned i = (ROUNDS); i-- > 0; ) {                                           \
+        y = NAME##_Ror(y ^ x, SPECK_FAMILY_BETA(BITS));                                \
+        x = NAME##_Rol(NAME##_Mask((WORD)((x ^ ctx->round_keys[i]) - y)), SPECK_FAMILY_ALPHA(BITS)); \
+    }                                                                                  \
+                                                                                       \
+    *px = x;                                                                           \
+    *py = y;                                                                           \
+}                                                                                      \
+                                                                                       \
+static inline void NAME##_Encrypt(const NAME##_Context* ctx, const uint8_t* in, uint8_t* out) { \
+    WORD x = NAME##_Load(in);                                                          \
+    WORD y = NAME##_Load(in + (BITS) / 8);                                             \
+    NAME##_EncryptWords(ctx, &x, &y);                                                  \
+    NAME##_Store(x, out);                                                              \
+    NAME##_Store(y, out + (BITS) / 8);                                                 \
+}                                                                                      \
+                                                                                       \
+static inline void NAME##_Decrypt(const NAME##_Context* ctx, const uint8_t* in, uint8_t* out) { \
+    WORD x = NAME##_Load(in);                                                          \
+    WORD y = NAME##_Load(in + (BITS) / 8);                                             \
+    NAME##_DecryptWords(ctx, &x, &y);                                                  \
+    NAME##_Store(x, out);                                                              \
+    NAME##_Store(y, out + (BITS) / 8);                                                 \
+}
+
+/* Сдвиги: (7, 2) для 16-битных слов, (8, 3) для остальных */
+#define SPECK_FAMILY_ALPHA(BITS) ((BITS) == 16 ? 7u : 8u)
+#define SPECK_FAMILY_BETA(BITS)  ((BITS) == 16 ? 2u : 3u)
+
+/* Стандартные варианты (блок/ключ в битах) */
+SPECK_FAMILY_DEFINE(Speck32_64,   uint16_t, 16, 4, 22)
+SPECK_FAMILY_DEFINE(Speck48_72,   uint32_t, 24, 3, 22)
+SPECK_FAMILY_DEFINE(Speck48_96,   uint32_t, 24, 4, 23)
+SPECK_FAMILY_DEFINE(Speck64_96,   uint32_t, 32, 3, 26)
+SPECK_FAMILY_DEFINE(Speck64_128,  uint32_t, 32, 4, 27)
+SPECK_FAMILY_DEFINE(Speck96_96,   uint64_t, 48, 2, 28)
+SPECK_FAMILY_DEFINE(Speck96_144,  uint64_t, 48, 3, 29)
+SPECK_FAMILY_DEFINE(Speck128_128, uint64_t, 64, 2, 32)
+SPECK_FAMILY_DEFINE(Speck128_192, uint64_t, 64, 3, 33)
+SPECK_FAMILY_DEFINE(Speck128_256, uint64_t, 64, 4, 34)
+
+#endif /* SPECK_FAMILY_H_ */
@@ -0,0 +1,362 @@
+/**
+ * @file speck_simd.c
+ * @brief Многоблочный Speck64/128 для хоста с выбором SSE2/AVX2/AVX-512
+ */
+
+#include "speck_simd.h"
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SPECK_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SPECK_SIMD_X86 0
+#endif
+
+/* Ядро: обрабатывает nblocks блоков, хвост меньше ширины вектора - эталоном */
+typedef void (*SpeckBlocksFn)(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks);
+
+typedef struct {
+    SpeckBlocksFn encrypt;
+    SpeckBlocksFn decrypt;
+    size_t lanes;
+    const char* name;
+} SpeckSimdEngine;
+
+static void scalar_encrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    for (size_t i = 0; i < nblocks; i++) {
+        Speck_Encrypt(ctx, in + i * SPECK_BLOCK_SIZE, out + i * SPECK_BLOCK_SIZE);
+    }
+}
+
+static void scalar_decrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    for (size_t i = 0; i < nblocks; i++) {
+        Speck_Decrypt(ctx, in + i * SPECK_BLOCK_SIZE, out + i * SPECK_BLOCK_SIZE);
+    }
+}
+
+#if SPECK_SIMD_X86
+
+/*
+ * Упаковка: блок - два слова little-endian (x, y), как в Speck_Encrypt.
+ * shuffle_ps(a, b, 2,0,2,0) собирает четные слова (x) пар блоков, 3,1,3,1 - нечетные (y);
+ * unpacklo/unpackhi_epi32(x, y) восстанавливают исходный порядок блоков
+ * в каждой 128-битной полосе, поэтому для AVX2/AVX-512 перестановка между
+ * полосами не нужна.
+ */
+
+/* --- SSE2: 4 блока --- */
+
+#define SSE_ROR(v, r) _mm_or_si128(_mm_srli_epi32((v), (r)), _mm_slli_epi32((v), 32 - (r)))
+#define SSE_ROL(v, r) _mm_or_si128(_mm_slli_epi32((v), (r)), _mm_srli_epi32((v), 32 - (r)))
+
+__attribute__((target("sse2")))
+static void sse2_encrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    size_t i = 0;
+
+    for (; i + 4 <= nblocks; i += 4) {
+        __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(in + i * 8)));
+        __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(in + i * 8 + 16)));
+        __m128i x = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i y = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (int r = 0; r < SPECK_ROUNDS; r++) {
+            __m128i k = _mm_set1_epi32((int)ctx->round_keys[r]);
+            x = _mm_xor_si128(_mm_add_epi32(SSE_ROR(x, 8), y), k);
+            y = _mm_xor_si128(SSE_ROL(y, 3), x);
+        }
+
+        _mm_storeu_si128((__m128i*)(out + i * 8), _mm_unpacklo_epi32(x, y));
+        _mm_storeu_si128((__m128i*)(out + i * 8 + 16), _mm_unpackhi_epi32(x, y));
+    }
+
+    scalar_encrypt(ctx, in + i * 8, out + i * 8, nblocks - i);
+}
+
+__attribute__((target("sse2")))
+static void sse2_decrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    size_t i = 0;
+
+    for (; i + 4 <= nblocks; i += 4) {
+        __m128 a = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(in + i * 8)));
+        __m128 b = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(in + i * 8 + 16)));
+        __m128i x = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m128i y = _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (int r = SPECK_ROUNDS - 1; r >= 0; r--) {
+            __m128i k = _mm_set1_epi32((int)ctx->round_keys[r]);
+            y = _mm_xor_si128(y, x);
+            y = SSE_ROR(y, 3);
+            x = _mm_sub_epi32(_mm_xor_si128(x, k), y);
+            x = SSE_ROL(x, 8);
+        }
+
+        _mm_storeu_si128((__m128i*)(out + i * 8), _mm_unpacklo_epi32(x, y));
+        _mm_storeu_si128((__m128i*)(out + i * 8 + 16), _mm_unpackhi_epi32(x, y));
+    }
+
+    scalar_decrypt(ctx, in + i * 8, out + i * 8, nblocks - i);
+}
+
+/* --- AVX2: 8 блоков, поворот на 8 бит - перестановкой байтов --- */
+
+#define AVX2_ROR(v, r) _mm256_or_si256(_mm256_srli_epi32((v), (r)), _mm256_slli_epi32((v), 32 - (r)))
+#define AVX2_ROL(v, r) _mm256_or_si256(_mm256_slli_epi32((v), (r)), _mm256_srli_epi32((v), 32 - (r)))
+
+__attribute__((target("avx2")))
+static void avx2_encrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const __m256i ror8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+                                          1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    size_t i = 0;
+
+    for (; i + 8 <= nblocks; i += 8) {
+        __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(in + i * 8)));
+        __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(in + i * 8 + 32)));
+        __m256i x = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m256i y = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (int r = 0; r < SPECK_ROUNDS; r++) {
+            __m256i k = _mm256_set1_epi32((int)ctx->round_keys[r]);
+            x = _mm256_xor_si256(_mm256_add_epi32(_mm256_shuffle_epi8(x, ror8), y), k);
+            y = _mm256_xor_si256(AVX2_ROL(y, 3), x);
+        }
+
+        _mm256_storeu_si256((__m256i*)(out + i * 8), _mm256_unpacklo_epi32(x, y));
+        _mm256_storeu_si256((__m256i*)(out + i * 8 + 32), _mm256_unpackhi_epi32(x, y));
+    }
+
+    sse2_encrypt(ctx, in + i * 8, out + i * 8, nblocks - i);
+}
+
+__attribute__((target("avx2")))
+static void avx2_decrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    const __m256i rol8 = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    size_t i = 0;
+
+    for (; i + 8 <= nblocks; i += 8) {
+        __m256 a = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(in + i * 8)));
+        __m256 b = _mm256_castsi256_ps(_mm256_loadu_si256((const __m256i*)(in + i * 8 + 32)));
+        __m256i x = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m256i y = _mm256_castps_si256(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (int r = SPECK_ROUNDS - 1; r >= 0; r--) {
+            __m256i k = _mm256_set1_epi32((int)ctx->round_keys[r]);
+            y = AVX2_ROR(_mm256_xor_si256(y, x), 3);
+            x = _mm256_shuffle_epi8(_mm256_sub_epi32(_mm256_xor_si256(x, k), y), rol8);
+        }
+
+        _mm256_storeu_si256((__m256i*)(out + i * 8), _mm256_unpacklo_epi32(x, y));
+        _mm256_storeu_si256((__m256i*)(out + i * 8 + 32), _mm256_unpackhi_epi32(x, y));
+    }
+
+    sse2_decrypt(ctx, in + i * 8, out + i * 8, nblocks - i);
+}
+
+/* --- AVX-512: 16 блоков, аппаратные повороты VPRORD/VPROLD --- */
+
+__attribute__((target("avx512f")))
+static void avx512_encrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    size_t i = 0;
+
+    for (; i + 16 <= nblocks; i += 16) {
+        __m512 a = _mm512_castsi512_ps(_mm512_loadu_si512((const void*)(in + i * 8)));
+        __m512 b = _mm512_castsi512_ps(_mm512_loadu_si512((const void*)(in + i * 8 + 64)));
+        __m512i x = _mm512_castps_si512(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m512i y = _mm512_castps_si512(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (int r = 0; r < SPECK_ROUNDS; r++) {
+            __m512i k = _mm512_set1_epi32((int)ctx->round_keys[r]);
+            x = _mm512_xor_si512(_mm512_add_epi32(_mm512_ror_epi32(x, 8), y), k);
+            y = _mm512_xor_si512(_mm512_rol_epi32(y, 3), x);
+        }
+
+        _mm512_storeu_si512((void*)(out + i * 8), _mm512_unpacklo_epi32(x, y));
+        _mm512_storeu_si512((void*)(out + i * 8 + 64), _mm512_unpackhi_epi32(x, y));
+    }
+
+    avx2_encrypt(ctx, in + i * 8, out + i * 8, nblocks - i);
+}
+
+__attribute__((target("avx512f")))
+static void avx512_decrypt(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    size_t i = 0;
+
+    for (; i + 16 <= nblocks; i += 16) {
+        __m512 a = _mm512_castsi512_ps(_mm512_loadu_si512((const void*)(in + i * 8)));
+        __m512 b = _mm512_castsi512_ps(_mm512_loadu_si512((const void*)(in + i * 8 + 64)));
+        __m512i x = _mm512_castps_si512(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        __m512i y = _mm512_castps_si512(_mm512_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+
+        for (int r = SPECK_ROUNDS - 1; r >= 0; r--) {
+            __m512i k = _mm512_set1_epi32((int)ctx->round_keys[r]);
+            y = _mm512_ror_epi32(_mm512_xor_si512(y, x), 3);
+            x = _mm512_rol_epi32(_mm512_sub_epi32(_mm512_xor_si512(x, k), y), 8);
+        }
+
+        _mm512_storeu_si512((void*)(out + i * 8), _mm512_unpacklo_epi32(x, y));
+        _mm512_storeu_si512((void*)(out + i * 8 + 64), _mm512_unpackhi_epi32(x, y));
+    }
+
+    avx2_decrypt(ctx, in + i * 8, out + i * 8, nblocks - i);
+}
+
+#endif /* SPECK_SIMD_X86 */
+
+static const SpeckSimdEngine engines[] = {
+    [SPECK_SIMD_SCALAR] = { scalar_encrypt, scalar_decrypt, 1, "scalar" },
+#if SPECK_SIMD_X86
+    [SPECK_SIMD_SSE2]   = { sse2_encrypt, sse2_decrypt, 4, "sse2" },
+    [SPECK_SIMD_AVX2]   = { avx2_encrypt, avx2_decrypt, 8, "avx2" },
+    [SPECK_SIMD_AVX512] = { avx512_encrypt, avx512_decrypt, 16, "avx512" },
+#endif
+};
+
+static int current_isa = -1;  // -1 - еще не выбрана
+
+SpeckSimdIsa Speck_SIMD_Detect(void) {
+#if SPECK_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+        return SPECK_SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return SPECK_SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return SPECK_SIMD_SSE2;
+    }
+#endif
+    return SPECK_SIMD_SCALAR;
+}
+
+SpeckSimdIsa Speck_SIMD_Select(SpeckSimdIsa isa) {
+    SpeckSimdIsa best = Speck_SIMD_Detect();
+
+    if (isa > best) {
+        isa = best;
+    }
+    current_isa = (int)isa;
+    return isa;
+}
+
+SpeckSimdIsa Speck_SIMD_Current(void) {
+    // Гонка при первом вызове безопасна: все потоки выберут одно и то же
+    if (current_isa < 0) {
+        current_isa = (int)Speck_SIMD_Detect();
+    }
+    return (SpeckSimdIsa)current_isa;
+}
+
+const char* Speck_SIMD_Name(SpeckSimdIsa isa) {
+    if ((size_t)isa >= sizeof(engines) / sizeof(engines[0]) || engines[isa].name == NULL) {
+        return "unknown";
+    }
+    return engines[isa].name;
+}
+
+void Speck_EncryptBlocks(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    engines[Speck_SIMD_Current()].encrypt(ctx, in, out, nblocks);
+}
+
+void Speck_DecryptBlocks(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks) {
+    engines[Speck_SIMD_Current()].decrypt(ctx, in, out, nblocks);
+}
+
+/**
+ * @brief Запись 32-битного слова в массив байтов (little-endian)
+ */
+static void put_word(uint32_t word, uint8_t* bytes) {
+    bytes[0] = (uint8_t)(word);
+    bytes[1] = (uint8_t)(word >> 8);
+    bytes[2] = (uint8_t)(word >> 16);
+    bytes[3] = (uint8_t)(word >> 24);
+}
+
+/**
+ * @brief Перестановка байтов в каждом 32-битном слове: раскладка ядер
+ *        (little-endian) <-> раскладка прошивки (big-endian)
+ */
+static void swap_words(const uint8_t* in, uint8_t* out, size_t nwords) {
+    for (size_t i = 0; i < nwords; i++) {
+        uint8_t b0 = in[4 * i], b1 = in[4 * i + 1];
+        out[4 * i] = in[4 * i + 3];
+        out[4 * i + 1] = in[4 * i + 2];
+        out[4 * i + 2] = b1;
+        out[4 * i + 3] = b0;
+    }
+}
+
+void Speck_CTR_Keystream(const SpeckContext* ctx, uint32_t nonce, uint32_t first_counter,
+                        uint8_t* out, size_t nblocks) {
+    // Раскладываем счетные блоки прямо в выходной буфер и шифруем на месте
+    for (size_t i = 0; i < nblocks; i++) {
+        put_word(nonce, out + i * SPECK_BLOCK_SIZE);
+        put_word(first_counter + (uint32_t)i, out + i * SPECK_BLOCK_SIZE + 4);
+    }
+
+    Speck_EncryptBlocks(ctx, out, out, nblocks);
+
+    // Гамма прошивки (SecUart_KeystreamBlock) - слова x, y в big-endian
+    swap_words(out, out, nblocks * 2);
+}
+
+void Speck_CBC_MAC_Multi(const SpeckContext* ctx, const uint8_t* const* data, const size_t* len,
+                        uint8_t* macs, size_t count) {
+    uint8_t state[SPECK_SIMD_MAX_LANES * SPECK_BLOCK_SIZE];
+    uint8_t active[SPECK_SIMD_MAX_LANES * SPECK_BLOCK_SIZE];
+    size_t lane_of[SPECK_SIMD_MAX_LANES];
+
+    for (size_t base = 0; base < count; base += SPECK_SIMD_MAX_LANES) {
+        size_t group = count - base;
+        size_t max_blocks = 0;
+
+        if (group > SPECK_SIMD_MAX_LANES) {
+            group = SPECK_SIMD_MAX_LANES;
+        }
+
+        // Нулевой IV для всех цепочек группы
+        memset(state, 0, group * SPECK_BLOCK_SIZE);
+        for (size_t l = 0; l < group; l++) {
+            size_t blocks = (len[base + l] + SPECK_BLOCK_SIZE - 1) / SPECK_BLOCK_SIZE;
+            if (blocks > max_blocks) {
+                max_blocks = blocks;
+            }
+        }
+
+        for (size_t b = 0; b < max_blocks; b++) {
+            size_t n = 0;
+            size_t offset = b * SPECK_BLOCK_SIZE;
+
+            // Собираем цепочки, у которых еще есть блок, подряд в один вектор
+            for (size_t l = 0; l < group; l++) {
+                size_t msg_len = len[base + l];
+                if (offset >= msg_len) {
+                    continue;
+                }
+
+                size_t take = msg_len - offset;
+                if (take > SPECK_BLOCK_SIZE) {
+                    take = SPECK_BLOCK_SIZE;
+                }
+
+                // Слова сообщения big-endian, как speck_mac в прошивке: байт j
+                // попадает в байт j ^ 3 слова в раскладке ядра
+                uint8_t* lane = active + n * SPECK_BLOCK_SIZE;
+                memcpy(lane, state + l * SPECK_BLOCK_SIZE, SPECK_BLOCK_SIZE);
+                for (size_t j = 0; j < take; j++) {
+                    lane[j ^ 3] ^= data[base + l][offset + j];
+                }
+                lane_of[n++] = l;
+            }
+
+            Speck_EncryptBlocks(ctx, active, active, n);
+
+            for (size_t i = 0; i < n; i++) {
+                memcpy(state + lane_of[i] * SPECK_BLOCK_SIZE, active + i * SPECK_BLOCK_SIZE, SPECK_BLOCK_SIZE);
+            }
+        }
+
+        swap_words(state, macs + base * SPECK_BLOCK_SIZE, group * 2);
+    }
+}
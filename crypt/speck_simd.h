@@ -0,0 +1,103 @@
+/**
+ * @file speck_simd.h
+ * @brief Многоблочный Speck64/128 для хоста (SSE2/AVX2/AVX-512)
+ *
+ * Обрабатывает 4, 8 или 16 независимых блоков за проход: слова x и y
+ * разных блоков раскладываются по линиям вектора, раунд ARX выполняется
+ * сразу для всех линий. Набор инструкций выбирается во время выполнения,
+ * результат побитово совпадает с Speck_Encrypt/Speck_Decrypt.
+ */
+
+#ifndef SPECK_SIMD_H_
+#define SPECK_SIMD_H_
+
+#include "speck.h"
+
+#define SPECK_SIMD_MAX_LANES  16   // Максимум блоков за один векторный проход
+
+/* Реализации многоблочного ядра */
+typedef enum {
+    SPECK_SIMD_SCALAR = 0,   // Эталонная реализация Speck_Encrypt/Speck_Decrypt
+    SPECK_SIMD_SSE2,         // 4 блока за проход
+    SPECK_SIMD_AVX2,         // 8 блоков за проход
+    SPECK_SIMD_AVX512        // 16 блоков за проход
+} SpeckSimdIsa;
+
+/**
+ * @brief Определение лучшей реализации, поддерживаемой процессором
+ *
+ * @return Самый широкий доступный набор инструкций
+ */
+SpeckSimdIsa Speck_SIMD_Detect(void);
+
+/**
+ * @brief Принудительный выбор реализации (например, для сверки всех путей)
+ *
+ * @param isa Желаемая реализация
+ * @return Фактически выбранная реализация (не шире поддерживаемой процессором)
+ */
+SpeckSimdIsa Speck_SIMD_Select(SpeckSimdIsa isa);
+
+/**
+ * @brief Текущая реализация (при первом вызове выбирается Speck_SIMD_Detect)
+ */
+SpeckSimdIsa Speck_SIMD_Current(void);
+
+/**
+ * @brief Название реализации для логов и бенчмарков
+ */
+const char* Speck_SIMD_Name(SpeckSimdIsa isa);
+
+/**
+ * @brief Шифрование независимых блоков (ECB)
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param in Открытый текст (nblocks * 8 байт)
+ * @param out Буфер для шифротекста (может совпадать с in)
+ * @param nblocks Количество блоков
+ */
+void Speck_EncryptBlocks(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks);
+
+/**
+ * @brief Расшифрование независимых блоков (ECB)
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param in Шифротекст (nblocks * 8 байт)
+ * @param out Буфер для открытого текста (может совпадать с in)
+ * @param nblocks Количество блоков
+ */
+void Speck_DecryptBlocks(const SpeckContext* ctx, const uint8_t* in, uint8_t* out, size_t nblocks);
+
+/**
+ * @brief Гамма режима CTR: блок j = Speck(x = nonce, y = first_counter + j)
+ *
+ * Слова x, y выходного блока записываются big-endian - побайтно та же гамма,
+ * что SecUart_KeystreamBlock в прошивке (nonce - CNT фрейма, first_counter -
+ * бит направления и номер блока).
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param nonce Старшее слово счетного блока (например, счетчик фрейма)
+ * @param first_counter Номер первого блока гаммы
+ * @param out Буфер для гаммы (nblocks * 8 байт)
+ * @param nblocks Количество блоков
+ */
+void Speck_CTR_Keystream(const SpeckContext* ctx, uint32_t nonce, uint32_t first_counter,
+                        uint8_t* out, size_t nblocks);
+
+/**
+ * @brief CBC-MAC (нулевой IV, дополнение нулями) сразу для нескольких сообщений
+ *
+ * Цепочки разных сообщений идут по линиям вектора, поэтому выигрыш
+ * получается при MAC многих фреймов от разных плат одновременно. Слова
+ * big-endian, результат совпадает с speck_mac прошивки и Speck_CBC_MAC_Scatter.
+ *
+ * @param ctx Указатель на контекст Speck
+ * @param data Массив указателей на сообщения
+ * @param len Массив длин сообщений в байтах
+ * @param macs Буфер для MAC (count * 8 байт)
+ * @param count Количество сообщений
+ */
+void Speck_CBC_MAC_Multi(const SpeckContext* ctx, const uint8_t* const* data, const size_t* len,
+                        uint8_t* macs, size_t count);
+
+#endif /* SPECK_SIMD_H_ */
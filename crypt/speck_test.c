@@ -0,0 +1,282 @@
+/**
+ * @file speck_test.c
+ * @brief Проверка Speck64/128 из crypt/ по опубликованным тестовым векторам (хост)
+ *
+ * Все десять вариантов из speck_family.h сверяются с векторами из статьи
+ * авторов, Speck64_128 семейства - еще и с Speck_Encrypt.
+ *
+ * Кроме эталона, побитово сверяет с ним все многоблочные ядра, доступные
+ * процессору (SSE2/AVX2/AVX-512), а гамму CTR и CBC-MAC - с ответами
+ * прошивки (SecUart_KeystreamBlock, speck_mac). Код возврата 0 - все
+ * проверки прошли, иначе печатаются несовпавшие и возвращается 1.
+ *
+ * Сборка: cc -O2 speck_test.c speck_simd.c speck.c -o speck_test && ./speck_test
+ */
+
+#include "speck_simd.h"
+#include "speck_family.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Speck64/128 из статьи авторов (слова l2 l1 l0 k0 и x y), байты в порядке
+// Speck_Init/Speck_Encrypt: каждое слово little-endian, k0 и x - первыми
+static const uint8_t vector_key[SPECK_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x08, 0x09, 0x0A, 0x0B,
+    0x10, 0x11, 0x12, 0x13, 0x18, 0x19, 0x1A, 0x1B
+};
+static const uint8_t vector_plain[SPECK_BLOCK_SIZE] = {
+    0x74, 0x65, 0x72, 0x3B, 0x2D, 0x43, 0x75, 0x74
+};
+static const uint8_t vector_cipher[SPECK_BLOCK_SIZE] = {
+    0x48, 0xA5, 0x6F, 0x8C, 0x8B, 0x02, 0x4E, 0x45
+};
+
+// Ответы прошивки для того же ключа: гамма CNT = 0x12345678, DIR = 1, блоки 0..2
+// и speck_mac по байтам 0x00..0x14 (21 байт, неполный последний блок)
+static const uint8_t firmware_keystream[3 * SPECK_BLOCK_SIZE] = {
+    0x6A, 0x8E, 0xD1, 0xE7, 0x33, 0x74, 0xA4, 0x99,
+    0x7D, 0x77, 0x72, 0x28, 0xF0, 0xBD, 0x2D, 0x4E,
+    0x2A, 0xC4, 0xE6, 0x14, 0x27, 0x6C, 0xCE, 0x14
+};
+static const uint8_t firmware_mac[SPECK_BLOCK_SIZE] = {
+    0x77, 0xC1, 0xDD, 0x63, 0xEF, 0x6A, 0x82, 0x04
+};
+
+// Векторы семейства в записи статьи: ключ l[m-2] .. l[0] k[0], блок x y
+typedef struct {
+    unsigned bits;
+    unsigned kwords;
+    uint64_t key[4];
+    uint64_t plain[2];
+    uint64_t cipher[2];
+} FamilyVector;
+
+static const FamilyVector family_vectors[] = {
+    { 16, 4, { 0x1918, 0x1110, 0x0908, 0x0100 },
+      { 0x6574, 0x694c }, { 0xa868, 0x42f2 } },
+    { 24, 3, { 0x121110, 0x0a0908, 0x020100 },
+      { 0x20796c, 0x6c6172 }, { 0xc049a5, 0x385adc } },
+    { 24, 4, { 0x1a1918, 0x121110, 0x0a0908, 0x020100 },
+      { 0x6d2073, 0x696874 }, { 0x735e10, 0xb6445d } },
+    { 32, 3, { 0x13121110, 0x0b0a0908, 0x03020100 },
+      { 0x74614620, 0x736e6165 }, { 0x9f7952ec, 0x4175946c } },
+    { 32, 4, { 0x1b1a1918, 0x13121110, 0x0b0a0908, 0x03020100 },
+      { 0x3b726574, 0x7475432d }, { 0x8c6fa548, 0x454e028b } },
+    { 48, 2, { 0x0d0c0b0a0908, 0x050403020100 },
+      { 0x65776f68202c, 0x656761737520 }, { 0x9e4d09ab7178, 0x62bdde8f79aa } },
+    { 48, 3, { 0x151413121110, 0x0d0c0b0a0908, 0x050403020100 },
+      { 0x656d6974206e, 0x69202c726576 }, { 0x2bf31072228a, 0x7ae440252ee6 } },
+    { 64, 2, { 0x0f0e0d0c0b0a0908, 0x0706050403020100 },
+      { 0x6c61766975716520, 0x7469206564616d20 }, { 0xa65d985179783265, 0x7860fedf5c570d18 } },
+    { 64, 3, { 0x1716151413121110, 0x0f0e0d0c0b0a0908, 0x0706050403020100 },
+      { 0x7261482066656968, 0x43206f7420746e65 }, { 0x1be4cf3a13135566, 0xf9bc185de03c1886 } },
+    { 64, 4, { 0x1f1e1d1c1b1a1918, 0x1716151413121110, 0x0f0e0d0c0b0a0908, 0x0706050403020100 },
+      { 0x65736f6874206e49, 0x202e72656e6f6f70 }, { 0x4109010405c0f53e, 0x4eeeb48d9c188f43 } },
+};
+
+#define SIMD_TEST_BLOCKS  100      // Покрывает полные проходы и хвосты всех ширин
+
+static int failures = 0;
+
+static void check(const char* name, const uint8_t* got, const uint8_t* expected, size_t len) {
+    if (memcmp(got, expected, len) == 0) {
+        return;
+    }
+
+    printf("FAIL %s:", name);
+    for (size_t i = 0; i < len; i++) {
+        printf(" %02X", got[i]);
+    }
+    printf("\n");
+    failures++;
+}
+
+/**
+ * @brief Слова в байты в упаковке семейства: little-endian, k[0] и x - первыми
+ */
+static void family_bytes(const uint64_t* words, unsigned count, unsigned bits, uint8_t* out) {
+    for (unsigned w = 0; w < count; w++) {
+        for (unsigned b = 0; b < bits / 8; b++) {
+            out[w * (bits / 8) + b] = (uint8_t)(words[count - 1 - w] >> (8 * b));
+        }
+    }
+}
+
+/**
+ * @brief Векторы статьи для всех вариантов семейства
+ */
+static void check_family(void) {
+    uint8_t key[32], plain[16], cipher[16], block[16];
+    uint64_t block_words[2];
+
+// Вариант NAME проверяется по family_vectors[I]
+#define SPECK_FAMILY_CHECK(NAME, I)                                                   \
+    do {                                                                              \
+        const FamilyVector* v = &family_vectors[I];                                   \
+        NAME##_Context c;                                                             \
+                                                                                      \
+        family_bytes(v->key, v->kwords, v->bits, key);                                \
+        /* x идет первым, поэтому слова блока разворачиваются из порядка x y */       \
+        block_words[0] = v->plain[1];                                                 \
+        block_words[1] = v->plain[0];                                                 \
+        family_bytes(block_words, 2, v->bits, plain);                                 \
+        block_words[0] = v->cipher[1];                                                \
+        block_words[1] = v->cipher[0];                                                \
+        family_bytes(block_words, 2, v->bits, cipher);                                \
+                                                                                      \
+        NAME##_Init(&c, key);                                                         \
+        NAME##_Encrypt(&c, plain, block);                                             \
+        check(#NAME " encrypt", block, cipher, NAME##_BLOCK_SIZE);                    \
+        NAME##_Decrypt(&c, cipher, block);                                            \
+        check(#NAME " decrypt", block, plain, NAME##_BLOCK_SIZE);                     \
+    } while (0)
+
+    SPECK_FAMILY_CHECK(Speck32_64, 0);
+    SPECK_FAMILY_CHECK(Speck48_72, 1);
+    SPECK_FAMILY_CHECK(Speck48_96, 2);
+    SPECK_FAMILY_CHECK(Speck64_96, 3);
+    SPECK_FAMILY_CHECK(Speck64_128, 4);
+    SPECK_FAMILY_CHECK(Speck96_96, 5);
+    SPECK_FAMILY_CHECK(Speck96_144, 6);
+    SPECK_FAMILY_CHECK(Speck128_128, 7);
+    SPECK_FAMILY_CHECK(Speck128_192, 8);
+    SPECK_FAMILY_CHECK(Speck128_256, 9);
+
+#undef SPECK_FAMILY_CHECK
+
+    // Вариант семейства и crypt/speck.c - один и тот же шифр
+    {
+        Speck64_128_Context c;
+        SpeckContext ref;
+
+        Speck64_128_Init(&c, vector_key);
+        Speck_Init(&ref, vector_key);
+        Speck_Encrypt(&ref, vector_cipher, plain);
+        Speck64_128_Encrypt(&c, vector_cipher, block);
+        check("Speck64_128 vs Speck_Encrypt", block, plain, SPECK_BLOCK_SIZE);
+    }
+}
+
+/**
+ * @brief Развертка ключа поверх мусора в стеке: результат не должен от него зависеть
+ */
+static void init_dirty(SpeckContext* ctx, uint8_t fill) {
+    volatile uint8_t dirt[256];
+
+    for (size_t i = 0; i < sizeof(dirt); i++) {
+        dirt[i] = fill;
+    }
+
+    Speck_Init(ctx, vector_key);
+}
+
+int main(void) {
+    SpeckContext ctx, other;
+    uint8_t block[SPECK_BLOCK_SIZE];
+
+    // Шифрование и расшифрование тестового блока
+    Speck_Init(&ctx, vector_key);
+    Speck_Encrypt(&ctx, vector_plain, block);
+    check("encrypt", block, vector_cipher, sizeof(block));
+
+    Speck_Decrypt(&ctx, vector_cipher, block);
+    check("decrypt", block, vector_plain, sizeof(block));
+
+    check_family();
+
+    // Раундовые ключи определяются только ключом
+    init_dirty(&ctx, 0x00);
+    init_dirty(&other, 0xA5);
+    check("key schedule", (const uint8_t*)other.round_keys,
+          (const uint8_t*)ctx.round_keys, sizeof(ctx.round_keys));
+
+    // CBC: дополнение PKCS#7 и обратное преобразование
+    {
+        static const uint8_t iv[SPECK_BLOCK_SIZE] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+        uint8_t plain[37];
+        uint8_t cipher[sizeof(plain) + SPECK_BLOCK_SIZE];
+        uint8_t back[sizeof(cipher)];
+
+        for (size_t i = 0; i < sizeof(plain); i++) {
+            plain[i] = (uint8_t)(i * 7 + 3);
+        }
+
+        size_t clen = Speck_CBC_Encrypt(&ctx, plain, sizeof(plain), iv, cipher);
+        size_t plen = Speck_CBC_Decrypt(&ctx, cipher, clen, iv, back);
+        if (clen != 40 || plen != sizeof(plain)) {
+            printf("FAIL cbc length: %zu/%zu\n", clen, plen);
+            failures++;
+        }
+        check("cbc", back, plain, sizeof(plain));
+    }
+
+    // Многоблочные ядра против Speck_Encrypt/Speck_Decrypt на всех длинах
+    {
+        static uint8_t in[SIMD_TEST_BLOCKS * SPECK_BLOCK_SIZE];
+        static uint8_t ref[sizeof(in)], out[sizeof(in)];
+        SpeckSimdIsa best = Speck_SIMD_Detect();
+
+        srand(1);
+        for (size_t i = 0; i < sizeof(in); i++) {
+            in[i] = (uint8_t)rand();
+        }
+        for (size_t i = 0; i < SIMD_TEST_BLOCKS; i++) {
+            Speck_Encrypt(&ctx, in + i * SPECK_BLOCK_SIZE, ref + i * SPECK_BLOCK_SIZE);
+        }
+
+        for (int isa = SPECK_SIMD_SCALAR; isa <= (int)best; isa++) {
+            char name[48];
+
+            Speck_SIMD_Select((SpeckSimdIsa)isa);
+            for (size_t n = 0; n <= SIMD_TEST_BLOCKS; n++) {
+                Speck_EncryptBlocks(&ctx, in, out, n);
+                snprintf(name, sizeof(name), "%s encrypt %zu blocks", Speck_SIMD_Name(isa), n);
+                check(name, out, ref, n * SPECK_BLOCK_SIZE);
+
+                Speck_DecryptBlocks(&ctx, out, out, n);
+                snprintf(name, sizeof(name), "%s decrypt %zu blocks", Speck_SIMD_Name(isa), n);
+                check(name, out, in, n * SPECK_BLOCK_SIZE);
+            }
+
+            // Гамма и MAC - в раскладке прошивки
+            Speck_CTR_Keystream(&ctx, 0x12345678u, 0x80000000u, out, 3);
+            snprintf(name, sizeof(name), "%s ctr keystream", Speck_SIMD_Name(isa));
+            check(name, out, firmware_keystream, sizeof(firmware_keystream));
+
+            {
+                uint8_t msg[21];
+                const uint8_t* msgs[SPECK_SIMD_MAX_LANES + 1];
+                size_t lens[SPECK_SIMD_MAX_LANES + 1];
+                uint8_t macs[(SPECK_SIMD_MAX_LANES + 1) * SPECK_BLOCK_SIZE];
+
+                for (size_t i = 0; i < sizeof(msg); i++) {
+                    msg[i] = (uint8_t)i;
+                }
+                // Сообщения разной длины, чтобы цепочки выходили из вектора в разное время
+                for (size_t l = 0; l <= SPECK_SIMD_MAX_LANES; l++) {
+                    msgs[l] = (l == SPECK_SIMD_MAX_LANES) ? msg : in + l;
+                    lens[l] = (l == SPECK_SIMD_MAX_LANES) ? sizeof(msg) : l * 5;
+                }
+                Speck_CBC_MAC_Multi(&ctx, msgs, lens, macs, SPECK_SIMD_MAX_LANES + 1);
+
+                snprintf(name, sizeof(name), "%s cbc-mac", Speck_SIMD_Name(isa));
+                check(name, macs + SPECK_SIMD_MAX_LANES * SPECK_BLOCK_SIZE, firmware_mac, sizeof(firmware_mac));
+
+                for (size_t l = 0; l < SPECK_SIMD_MAX_LANES; l++) {
+                    SpeckSegment seg = { msgs[l], lens[l] };
+                    uint8_t mac[SPECK_BLOCK_SIZE];
+
+                    Speck_CBC_MAC_Scatter(&ctx, &seg, 1, mac);
+                    snprintf(name, sizeof(name), "%s cbc-mac lane %zu", Speck_SIMD_Name(isa), l);
+                    check(name, macs + l * SPECK_BLOCK_SIZE, mac, sizeof(mac));
+                }
+            }
+        }
+
+        printf("simd: checked scalar..%s\n", Speck_SIMD_Name(best));
+    }
+
+    printf("%s\n", failures ? "FAILED" : "OK");
+    return failures ? 1 : 0;
+}
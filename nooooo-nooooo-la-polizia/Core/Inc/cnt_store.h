@@ -0,0 +1,64 @@
+/**
+ * @file cnt_store.h
+ * @brief Хранение границы CNT передачи во flash между перезапусками
+ *
+ * Гамма CTR зависит только от ключа во flash и CNT, поэтому CNT после
+ * сброса не должен повторять уже отправленные. Во flash хранится граница:
+ * CNT до нее могли уйти на линию. Граница резервируется блоками, запись во
+ * flash нужна раз в блок, а после сброса передача продолжается с границы.
+ *
+ * Журнал: два сектора по 16 КБ (2 и 3, в скрипте компоновки между
+ * таблицей векторов и кодом), в активный пишутся слова с возрастающей
+ * границей, действует наибольшее. Заполненный сектор переносится в другой
+ * одним словом. Стирание (сотни мс без выборки из flash) не делается на
+ * пути передачи: старый сектор стирает CntStore_Service из основного цикла.
+ */
+
+#ifndef CNT_STORE_H
+#define CNT_STORE_H
+
+#include "main.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CNT_STORE_ADDR_A        0x08008000u         // Сектор 2, 16 КБ
+#define CNT_STORE_ADDR_B        0x0800C000u         // Сектор 3, 16 КБ
+#define CNT_STORE_SECTOR_A      FLASH_SECTOR_2
+#define CNT_STORE_SECTOR_B      FLASH_SECTOR_3
+#define CNT_STORE_SECTOR_SIZE   (16u * 1024u)
+#define CNT_STORE_WORDS         (CNT_STORE_SECTOR_SIZE / 4)
+#define CNT_STORE_EMPTY         0xFFFFFFFFu         // Стертое слово
+
+/**
+ * @brief Чтение сохраненной границы
+ * @note Неактивный сектор, если в нем что-то есть, стирается сразу: до
+ *       запуска UART стирание никому не мешает
+ * @param value Граница (0, если журнал пуст)
+ * @return false - стирание не удалось
+ */
+bool CntStore_Load(uint32_t *value);
+
+/**
+ * @brief Запись новой границы
+ * @note Только программирование слова, без стирания. Перенос в другой
+ *       сектор возможен, лишь когда CntStore_Service его уже стер
+ * @param value Граница, больше сохраненной и не равная CNT_STORE_EMPTY
+ * @return false - запись во flash не удалась (или другой сектор не стерт),
+ *         граница не сдвинута
+ */
+bool CntStore_Save(uint32_t value);
+
+/**
+ * @brief Ждет ли неактивный сектор стирания
+ */
+bool CntStore_Pending(void);
+
+/**
+ * @brief Стирание неактивного сектора после переноса (из основного цикла)
+ * @note Останавливает выборку из flash на время стирания сектора 16 КБ:
+ *       прерывания не обслуживаются, DMA продолжает работать
+ * @return false - стирание не удалось, будет повторено следующим вызовом
+ */
+bool CntStore_Service(void);
+
+#endif // CNT_STORE_H
@@ -0,0 +1,50 @@
+/**
+ * @file lzss.h
+ * @brief Сжатие LZSS для данных одного фрейма
+ *
+ * Вариант LZ77 под фреймы до 255 байт: смещение и длина совпадения
+ * занимают по байту, словарь - сами уже сжатые данные. Сжатию нужна
+ * хеш-таблица на 256 байт в стеке, распаковке - только выходной буфер.
+ *
+ * Формат: группы из управляющего байта и до 8 элементов. Бит i (с
+ * младшего) управляющего байта: 0 - литерал (1 байт), 1 - совпадение
+ * (2 байта: смещение - 1, длина - 3).
+ */
+
+#ifndef LZSS_H_
+#define LZSS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Параметры формата */
+#define LZSS_MAX_INPUT 255       // Наибольший размер сжимаемых данных (смещение - 1 байт)
+#define LZSS_MIN_MATCH 3         // Совпадения короче кодируются литералами
+#define LZSS_MAX_MATCH (LZSS_MIN_MATCH + 255)
+#define LZSS_HASH_BITS 8         // Хеш-таблица на 2^8 однобайтовых позиций
+
+/**
+ * @brief Сжатие данных
+ *
+ * @param in Указатель на данные
+ * @param len Длина данных (не больше LZSS_MAX_INPUT)
+ * @param out Буфер для сжатых данных (не пересекается с in)
+ * @param out_max Размер буфера
+ * @return Длина сжатых данных или 0, если они не помещаются в out_max
+ *         (в том числе если сжатие не уменьшает размер при out_max < len)
+ */
+size_t Lzss_Compress(const uint8_t* in, size_t len, uint8_t* out, size_t out_max);
+
+/**
+ * @brief Распаковка данных
+ *
+ * @param in Указатель на сжатые данные
+ * @param len Длина сжатых данных
+ * @param out Буфер для распакованных данных
+ * @param out_max Размер буфера
+ * @return Длина распакованных данных или 0, если данные повреждены или
+ *         не помещаются в out_max
+ */
+size_t Lzss_Decompress(const uint8_t* in, size_t len, uint8_t* out, size_t out_max);
+
+#endif /* LZSS_H_ */
@@ -0,0 +1,43 @@
+/**
+ * @file mac_bench.h
+ * @brief Сравнение стоимости MAC фрейма: Speck CBC-MAC, HalfSipHash, SipHash;
+ *        стоимость окна защиты от повтора; сжатие данных LZSS
+ */
+
+#ifndef MAC_BENCH_H
+#define MAC_BENCH_H
+
+#include "main.h"
+#include "speck.h"
+
+#define MAC_BENCH                  0                   // 1 - замер при старте, результат в монитор
+
+/**
+ * @brief Замер тактов DWT на MAC одного фрейма (заголовок + данные 8..255 байт)
+ * @note Для каждого размера берется минимум из нескольких прогонов, чтобы
+ *       исключить прерывания. Таблица выводится в huart построчно.
+ * @param huart UART монитора
+ * @param cipher Развернутый ключ Speck (для CBC-MAC)
+ */
+void MacBench_Run(UART_HandleTypeDef *huart, const SpeckContext *cipher);
+
+/**
+ * @brief Замер тактов DWT на проверку и отметку CNT в окне защиты от повтора
+ * @note Для каждой последовательности CNT (по порядку, с перестановками,
+ *       со скачками за окно, повторы) выводятся минимум и максимум тактов
+ *       на фрейм: оба не должны зависеть от CNT.
+ * @param huart UART монитора
+ */
+void MacBench_Replay(UART_HandleTypeDef *huart);
+
+/**
+ * @brief Замер сжатия LZSS на типичных данных фрейма
+ * @note Для текста, JSON, отсчетов АЦП и случайных байт выводятся размер до
+ *       и после сжатия, их отношение и такты DWT на исходный байт сжатия и
+ *       распаковки (минимум из нескольких прогонов). Данные, которые не
+ *       восстановились после распаковки, отмечаются строкой FAIL.
+ * @param huart UART монитора
+ */
+void MacBench_Compress(UART_HandleTypeDef *huart);
+
+#endif // MAC_BENCH_H
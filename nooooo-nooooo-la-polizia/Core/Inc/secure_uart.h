@@ -13,19 +13,204 @@
 
 // Определение размеров и констант
 #define SECUART_MAX_DATA_SIZE      255                 // Максимальный размер полезных данных
-#define SECUART_HEADER_SIZE        6                   // SOF(1) + CNT(4) + LEN(1)
-#define SECUART_MAC_SIZE           8                   // Размер MAC в байтах
+#define SECUART_HEADER_SIZE        6                   // Фрейм v1: SOF(1) + CNT(4) + LEN(1)
+#define SECUART_HEADER_SIZE_V2     8                   // Фрейм v2: SOF(1) + FLAGS(1) + RSV(1) + LEN(1) + CNT(4)
+#define SECUART_HEADER_SIZE_S8     3                   // Короткий фрейм: SOF(1) + CNT(1, младший байт) + LEN(1)
+#define SECUART_HEADER_SIZE_S16    4                   // Короткий фрейм: SOF(1) + CNT(2, младшие байты) + LEN(1)
+#define SECUART_HEADER_SIZE_EXT    12                  // Длинный фрейм v2: SOF(1) + FLAGS(1) + LEN(2) + CNT(4) + ~LEN(2) + нули(2)
+#define SECUART_HEADER_MAX         SECUART_HEADER_SIZE_V2
+#define SECUART_MAC_SIZE           8                   // Размер MAC в байтах (наибольший тег набора)
 #define SECUART_BLOCK_SIZE         8                   // Размер блока шифрования Speck
 #define SECUART_START_BYTE         0xAA                // Стартовый байт фрейма
-#define SECUART_BUFFER_SIZE        (SECUART_HEADER_SIZE + SECUART_MAX_DATA_SIZE + SECUART_MAC_SIZE)  // Размер буфера
+#define SECUART_START_BYTE_V2      0xAC                // Стартовый байт фрейма v2 (данные с границы 8 байт)
+#define SECUART_START_BYTE_S8      0xAD                // Стартовый байт короткого фрейма с 8 битами CNT
+#define SECUART_START_BYTE_S16     0xAE                // Стартовый байт короткого фрейма с 16 битами CNT
+#define SECUART_BUFFER_SIZE        (SECUART_HEADER_MAX + SECUART_MAX_DATA_SIZE + SECUART_MAC_SIZE)  // Размер буфера
+#define SECUART_BUFFER_ALIGN       8                   // Выравнивание слотов и кольца: данные фрейма v2 на границе блока
+#define SECUART_RX_RING_SIZE       1024                // Размер кольцевого буфера приема (степень двойки)
+#define SECUART_RX_RING_MASK       (SECUART_RX_RING_SIZE - 1)
+
+#define SECUART_TX_QUEUE_LEN       4                   // Глубина очереди фреймов на передачу (степень двойки)
+#define SECUART_TX_QUEUE_MASK      (SECUART_TX_QUEUE_LEN - 1)
+#define SECUART_RUNTIME_KEY        0                   // 1 - SecUart_Init разворачивает ключ в RAM, 0 - только готовые ключи во flash
+#define SECUART_TX_CUT_THROUGH     1                   // Старт DMA на заголовке, шифрование блоков впереди NDTR
+#define SECUART_TX_FENCE_GUARD     4                   // DMA ближе к незашифрованному блоку - передача обрывается
+#define SECUART_TX_ABORT_POLL      1000                // Предел опросов EN при остановке потока DMA передачи
+#ifndef SECUART_CYCLE_LOG
+#define SECUART_CYCLE_LOG          0                   // 1 - такты подготовки/передачи и MAC+расшифрования каждого фрейма в монитор
+#endif
+#ifndef SECUART_TX_FRAME_V2
+#define SECUART_TX_FRAME_V2        1                   // 1 - передаем фреймы v2, 0 - v1 для старых узлов (принимаются оба)
+#endif
+
+#ifndef SECUART_SHORT_CNT
+#if SECUART_TX_FRAME_V2
+#define SECUART_SHORT_CNT          16                  // Короткий заголовок: 8 или 16 младших бит CNT, 0 - всегда полный CNT
+#else
+#define SECUART_SHORT_CNT          0                   // Передача v1 - для старых узлов, короткие заголовки им неизвестны
+#endif
+#endif
+#define SECUART_SHORT_SYNC         64                  // Полный CNT - не реже чем раз в столько фреймов
+
+#ifndef SECUART_AGGREGATION
+#define SECUART_AGGREGATION        1                   // SecUart_Post: мелкие сообщения копятся в один фрейм
+#endif
+#define SECUART_AGG_DELAY_MS       5                   // Задержка сброса агрегата по умолчанию (agg_delay_ms)
+#define SECUART_AGG_SUBHDR_SIZE    2                   // Подзаголовок вложенного сообщения: LEN(1) + TYPE(1)
+#define SECUART_AGG_CAPACITY       (SECUART_MAX_DATA_SIZE - 1)  // Данные фрейма агрегата без его байта типа
+
+#ifndef SECUART_ARQ
+#define SECUART_ARQ                1                   // SecUart_SendReliable: selective repeat по ACK/NACK
+#endif
+#define SECUART_ARQ_WINDOW         8                   // Наибольшее окно неподтвержденных фреймов (степень двойки, до 32)
+#define SECUART_ARQ_TIMEOUT_MS     100                 // Повтор фрейма без подтверждения по умолчанию (arq_timeout_ms)
+#define SECUART_ARQ_MASK           (SECUART_ARQ_WINDOW - 1)
+
+#ifndef SECUART_BULK
+#define SECUART_BULK               1                   // SecUart_SendBulk: длинные фреймы (16-битный LEN, один MAC)
+#endif
+#ifndef SECUART_BULK_MAX_SIZE
+#define SECUART_BULK_MAX_SIZE      2048                // Наибольшее длинное сообщение (с байтом типа); RAM - втрое больше
+#endif
+#ifndef SECUART_BULK_POOL_LEN
+#define SECUART_BULK_POOL_LEN      2                   // Буферов сборки длинных сообщений на прием
+#endif
+
+#ifndef SECUART_LZ
+#define SECUART_LZ                 1                   // Сжатие данных фрейма LZSS перед шифрованием (tx_compress)
+#endif
+#define SECUART_LZ_MIN             16                  // Данные короче не сжимаются: выигрыша почти нет
+
+#define SECUART_REPLAY_WINDOW      64                  // Окно защиты от повтора, CNT (64 или 128)
+#define SECUART_REPLAY_WORDS       (2 * SECUART_REPLAY_WINDOW / 32)  // Кольцо слов битовой карты: окно и запас на сдвиг
+#define SECUART_REPLAY_MASK        (SECUART_REPLAY_WORDS - 1)
+
+#define SECUART_KS_POOL_LEN        2                   // Фреймов с готовой гаммой CTR на направление (степень двойки)
+#define SECUART_KS_POOL_MASK       (SECUART_KS_POOL_LEN - 1)
+#define SECUART_KS_BLOCKS          ((SECUART_MAX_DATA_SIZE + SECUART_BLOCK_SIZE - 1) / SECUART_BLOCK_SIZE)
+
+// CNT передачи не начинается с нуля после сброса: ключ во flash тот же, и
+// повтор CNT означал бы повтор гаммы. Граница CNT хранится во flash
+// (cnt_store.h) и сдвигается на SECUART_CNT_RESERVE перед тем, как CNT ее
+// перейдет; после сброса CNT продолжается с сохраненной границы. На пути
+// передачи журнал только программируется, сектор стирает SecUart_Poll
+#ifndef SECUART_CNT_PERSIST
+#define SECUART_CNT_PERSIST        1                   // 0 - CNT с нуля после сброса (только для стенда без второго узла)
+#endif
+#define SECUART_CNT_RESERVE        4096                // CNT на одну запись во flash
+
+// Блок счетчика CTR: [CNT][DIR | номер блока]. Оба узла ведут CNT под общим
+// ключом, поэтому в старшем бите второго слова - роль передатчика:
+// гамма A->B и B->A не совпадает ни для одного CNT. Роль входит и в MAC.
+//
+// Линии нужны два образа: второй узел собирается с противоположной ролью
+// (-DSECUART_NODE_ROLE=SECUART_ROLE_B). Два узла с одной прошивкой, как и
+// петля TX->RX одного узла, не примут ни одного фрейма: прием вернет
+// SECUART_ERR_ROLE (счетчик rx_role_mismatch), а не SECUART_ERR_INVALID_MAC
+#define SECUART_CTR_DIR_BIT        0x80000000u
+#ifndef SECUART_NODE_ROLE
+#define SECUART_NODE_ROLE          SECUART_ROLE_A      // Роль узла этой сборки; второй конец линии - SECUART_ROLE_B
+#endif
+
+// Наборы алгоритмов (cipher suite), собираемые в прошивку. Набор выбирается
+// для каждого контекста при инициализации; если собран ровно один, таблица
+// не хранится в контексте и вызовы через нее сворачиваются в прямые
+#ifndef SECUART_SUITE_SPECK
+#define SECUART_SUITE_SPECK        1                   // Speck-CTR + CBC-MAC на Speck64/128
+#endif
+#ifndef SECUART_SUITE_SIPHASH
+#define SECUART_SUITE_SIPHASH      0                   // Speck-CTR + SipHash-1-3
+#endif
+#ifndef SECUART_SUITE_HALFSIPHASH
+#define SECUART_SUITE_HALFSIPHASH  0                   // Speck-CTR + HalfSipHash-2-4-64 (32-битные слова)
+#endif
+#ifndef SECUART_SUITE_CRC
+#define SECUART_SUITE_CRC          0                   // Без шифрования, только CRC-16 (доверенный короткий кабель)
+#endif
+#define SECUART_SUITE_COUNT        (SECUART_SUITE_SPECK + SECUART_SUITE_SIPHASH + SECUART_SUITE_HALFSIPHASH + SECUART_SUITE_CRC)
+#define SECUART_MAC_KEY_SIZE       16                  // Ключ SipHash, выводится из ключа Speck
+
+#define SECUART_RX_QUEUE_LEN       4                   // Глубина очереди проверенных принятых фреймов (степень двойки)
+#define SECUART_RX_QUEUE_MASK      (SECUART_RX_QUEUE_LEN - 1)
+
+#if (SECUART_RX_QUEUE_LEN & SECUART_RX_QUEUE_MASK) != 0
+#error "SECUART_RX_QUEUE_LEN must be a power of two"
+#endif
+#if (SECUART_TX_QUEUE_LEN & SECUART_TX_QUEUE_MASK) != 0 || SECUART_TX_QUEUE_LEN < 2
+#error "SECUART_TX_QUEUE_LEN must be a power of two, at least 2 (ping-pong)"
+#endif
+#if (SECUART_ARQ_WINDOW & SECUART_ARQ_MASK) != 0 || SECUART_ARQ_WINDOW > 32
+#error "SECUART_ARQ_WINDOW must be a power of two, at most 32 (NACK bitmap)"
+#endif
+#if SECUART_HEADER_SIZE_EXT + SECUART_BULK_MAX_SIZE + SECUART_MAC_SIZE > 0xFFFF || SECUART_BULK_MAX_SIZE <= SECUART_MAX_DATA_SIZE
+#error "SECUART_BULK_MAX_SIZE must exceed SECUART_MAX_DATA_SIZE and fit a 16-bit frame length"
+#endif
+#if SECUART_SHORT_CNT != 0 && SECUART_SHORT_CNT != 8 && SECUART_SHORT_CNT != 16
+#error "SECUART_SHORT_CNT must be 0, 8 or 16"
+#endif
+#if SECUART_SHORT_CNT != 0 && !SECUART_TX_FRAME_V2
+#error "SECUART_SHORT_CNT requires SECUART_TX_FRAME_V2 (v1 peers do not parse short headers)"
+#endif
+#if SECUART_SHORT_SYNC < 1 || SECUART_SHORT_SYNC >= 128
+#error "SECUART_SHORT_SYNC must be below half of the 8-bit CNT range"
+#endif
+#if SECUART_REPLAY_WINDOW != 64 && SECUART_REPLAY_WINDOW != 128
+#error "SECUART_REPLAY_WINDOW must be 64 or 128"
+#endif
+#if (SECUART_KS_POOL_LEN & SECUART_KS_POOL_MASK) != 0
+#error "SECUART_KS_POOL_LEN must be a power of two"
+#endif
+#if (SECUART_RX_RING_SIZE & SECUART_RX_RING_MASK) != 0
+#error "SECUART_RX_RING_SIZE must be a power of two"
+#endif
+#if SECUART_RX_RING_SIZE < 2 * SECUART_BUFFER_SIZE
+#error "SECUART_RX_RING_SIZE must hold at least two full frames"
+#endif
+#if SECUART_SUITE_COUNT == 0
+#error "At least one SECUART_SUITE_* must be enabled"
+#endif
+
+#if SECUART_SUITE_SIPHASH
+#include "siphash.h"
+#endif
+#if SECUART_SUITE_HALFSIPHASH
+#include "halfsiphash.h"
+#endif
+#if SECUART_SUITE_CRC
+#include "crc_engine.h"
+#endif
+#if SECUART_LZ
+#include "lzss.h"
+#endif
+#if SECUART_CNT_PERSIST
+#include "cnt_store.h"
+#endif
 
 // Типы сообщений
 typedef enum {
     SECUART_MSG_DATA = 0x01,     // Обычные данные
     SECUART_MSG_ACK = 0x02,      // Подтверждение
-    SECUART_MSG_NACK = 0x03      // Отрицательное подтверждение
+    SECUART_MSG_NACK = 0x03,     // Отрицательное подтверждение
+    SECUART_MSG_AGGREGATE = 0x05 // Несколько сообщений: [LEN, TYPE, данные LEN байт]...
 } SecUartMsgType;
 
+// Флаги заголовка фрейма v2 (байт FLAGS)
+#define SECUART_FLAG_ARQ           0x01                // Надежный фрейм, RSV - номер ARQ
+#define SECUART_FLAG_EXT           0x02                // Длинный фрейм: RSV - старший байт LEN, за CNT - ~LEN и два нуля (SECUART_HEADER_SIZE_EXT)
+#define SECUART_FLAG_LZ            0x04                // Данные после типа сжаты LZSS (lzss.h)
+#define SECUART_FLAG_SYN           0x08                // Надежный фрейм номер 0 нового сеанса ARQ (узел перезапущен)
+
+// Сообщения ARQ (данные после типа): ACK - [NEXT], все номера до NEXT приняты;
+// NACK - [NEXT][MISSING, 4 байта BE], бит i - номер NEXT + i не принят
+#define SECUART_ARQ_ACK_SIZE       1
+#define SECUART_ARQ_NACK_SIZE      5
+
+// Роль узла на линии: у двух концов канала роли должны различаться
+typedef enum {
+    SECUART_ROLE_A = 0,          // Передает с DIR = 0
+    SECUART_ROLE_B = 1           // Передает с DIR = 1
+} SecUartRole;
+
 // Коды ошибок
 typedef enum {
     SECUART_OK = 0,              // Нет ошибок
@@ -33,40 +218,284 @@ typedef enum {
     SECUART_ERR_INVALID_MAC,     // Неверный MAC
     SECUART_ERR_REPLAY,          // Обнаружена Replay-атака
     SECUART_ERR_BUFFER_OVERFLOW, // Переполнение буфера
-    SECUART_ERR_TIMEOUT          // Таймаут операции
+    SECUART_ERR_TIMEOUT,         // Таймаут операции
+    SECUART_ERR_MALFORMED,       // MAC верен, но содержимое фрейма не разбирается (агрегат, сжатие)
+    SECUART_ERR_STORAGE,         // Граница CNT не сохранена во flash - передавать нельзя
+    SECUART_ERR_TX_START,        // Фрейм в очереди, но DMA не запустился - уйдет со следующим запуском (SecUart_Poll)
+    SECUART_ERR_ROLE             // MAC верен только для роли этого узла: второй узел собран с той же SECUART_NODE_ROLE (или петля)
 } SecUartError;
 
-// Структура контекста защищенного UART
+// Состояния потокового парсера приема
+typedef enum {
+    SECUART_RX_HUNT_SOF = 0,     // Поиск стартового байта
+    SECUART_RX_HEADER,           // Прием заголовка (CNT, LEN)
+    SECUART_RX_BODY,             // Прием данных и MAC
+    SECUART_RX_SKIP              // Пропуск длинного фрейма, для которого нет буфера сборки
+} SecUartRxState;
+
+// Готовый к отправке фрейм в очереди передачи
+typedef struct {
+    __ALIGNED(SECUART_BUFFER_ALIGN) uint8_t frame[SECUART_BUFFER_SIZE];  // Заголовок + шифротекст + MAC
+    uint16_t length;                     // Длина фрейма в байтах
+#if SECUART_BULK
+    const uint8_t *ext;                  // Длинный фрейм (tx_bulk) вместо frame, иначе NULL
+#endif
+} SecUartTxSlot;
+
+// Отправленный надежный фрейм: хранится зашифрованным до подтверждения,
+// повтор уходит теми же байтами (с тем же CNT) без повторного шифрования
 typedef struct {
+    __ALIGNED(SECUART_BUFFER_ALIGN) uint8_t frame[SECUART_BUFFER_SIZE];  // Готовый фрейм
+    uint16_t length;                     // Длина фрейма в байтах
+    uint32_t sent_at;                    // HAL_GetTick() последней передачи
+    bool acked;                          // Подтвержден выборочно (NACK), окно еще не сдвинулось
+} SecUartArqSlot;
+
+#if SECUART_BULK
+// Буфер сборки длинного сообщения: данные длинного фрейма прерывание пишет
+// сюда, а в слоте приема остается только заголовок
+typedef struct {
+    __ALIGNED(SECUART_BUFFER_ALIGN) uint8_t data[SECUART_BULK_MAX_SIZE + SECUART_MAC_SIZE];  // Тип + данные + MAC
+    volatile bool busy;                  // Собирается прерыванием или отдан приложению
+} SecUartBulkBuffer;
+#endif
+
+// Принятый фрейм: пока слот собирается прерыванием, открытый текст в нем
+// находится на карантине и становится виден приложению только после MAC
+typedef struct {
+    __ALIGNED(SECUART_BUFFER_ALIGN) uint8_t frame[SECUART_BUFFER_SIZE];  // Заголовок + открытый текст + MAC
+    uint32_t crypto_cycles;              // Такты на крипто после последнего байта
+    uint32_t counter;                    // Полный CNT (у короткого заголовка - восстановленный)
+#if SECUART_BULK
+    SecUartBulkBuffer *bulk;             // Данные длинного фрейма, NULL - данные в frame
+    uint16_t bulk_len;                   // Длина данных длинного фрейма (с типом)
+#endif
+} SecUartRxSlot;
+
+// Гамма CTR, заранее посчитанная для одного CNT
+typedef struct {
+    __ALIGNED(SECUART_BUFFER_ALIGN) uint8_t stream[SECUART_KS_BLOCKS * SECUART_BLOCK_SIZE];  // Блоки гаммы по порядку
+    volatile uint32_t counter;           // CNT, для которого считается гамма
+    volatile uint16_t blocks_ready;      // Сколько блоков stream уже готово
+} SecUartKeystream;
+
+// Потоковый MAC фрейма: состояние алгоритма набора
+typedef struct {
+    union {
+        SpeckMacContext speck;           // CBC-MAC на Speck64/128
+#if SECUART_SUITE_SIPHASH
+        SipHashContext sip;              // SipHash-1-3
+#endif
+#if SECUART_SUITE_HALFSIPHASH
+        HalfSipHashContext half;         // HalfSipHash-2-4-64
+#endif
+        uint16_t crc;                    // CRC-16
+    } state;                             // Состояние алгоритма набора
+} SecUartMac;
+
+struct SecUartContext;
+
+// Набор алгоритмов защиты фрейма. Шифрование потоковое: encrypt и decrypt
+// обрабатывают фрагмент данных фрейма со смещением offset (кратно block_size)
+typedef struct {
+    const char *name;            // Имя для журнала
+    uint8_t block_size;          // Шаг потоковой обработки данных, байт
+    uint8_t tag_size;            // Длина MAC/CRC в конце фрейма, байт (не больше SECUART_MAC_SIZE)
+
+    // Шифрование передаваемых / расшифрование принятых данных; NULL - данные идут открыто
+    void (*encrypt)(const struct SecUartContext *ctx, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size);
+    void (*decrypt)(const struct SecUartContext *ctx, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size);
+
+    // Потоковый MAC (или CRC) по заголовку и шифротексту
+    void (*mac_init)(const struct SecUartContext *ctx, SecUartMac *mac_ctx);
+    void (*mac_update)(const struct SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *data, uint16_t len);
+    void (*mac_final)(const struct SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *tag);
+} SecUartSuite;
+
+// Структура контекста защищенного UART
+typedef struct SecUartContext {
     // UART-интерфейсы
     UART_HandleTypeDef *huart_tx;       // UART для передачи
     UART_HandleTypeDef *huart_rx;       // UART для приема
     UART_HandleTypeDef *huart_monitor;  // UART для мониторинга
 
     // Буферы DMA
-    uint8_t tx_buffer[SECUART_BUFFER_SIZE];  // Буфер передачи
-    uint8_t rx_buffer[SECUART_BUFFER_SIZE];  // Буфер приема
+    __ALIGNED(SECUART_BUFFER_ALIGN) uint8_t rx_ring[SECUART_RX_RING_SIZE];   // Кольцевой буфер циклического DMA приема
+
+    // Индексы кольцевого буфера (свободно растущие, позиция = индекс & MASK)
+    volatile uint32_t rx_head;   // Сколько байт записал DMA
+    uint32_t rx_tail;            // Сколько байт разобрал потребитель
+    uint16_t rx_dma_pos;         // Последняя известная позиция DMA в кольце
+
+    // Состояние потокового парсера
+    SecUartRxState rx_state;     // Текущее состояние парсера
+    uint32_t rx_frame_start;     // Индекс SOF текущего фрейма в кольце
+    uint16_t rx_frame_pos;       // Сколько байт фрейма собрано в слоте приема
+    uint16_t rx_frame_len;       // Ожидаемая длина фрейма (после приема LEN)
+    uint16_t rx_crypt_pos;       // Сколько байт данных уже учтено в MAC и расшифровано
+    uint8_t *rx_payload;         // Куда собираются данные фрейма: слот или буфер сборки
+    uint16_t rx_data_len;        // Длина данных фрейма (LEN)
+    uint32_t rx_frame_cnt;       // CNT текущего фрейма (счетчик режима CTR)
+    uint32_t rx_cnt_ref;         // Старший CNT, прошедший MAC в прерывании: опора коротких заголовков
+    bool rx_cnt_ref_valid;       // Принят хотя бы один фрейм - короткие заголовки можно восстанавливать
+    SecUartMac rx_mac;           // Потоковый MAC текущего фрейма
+    SecUartMac rx_mac_own;       // Тот же MAC со своей ролью - пока rx_role_ok не установлен
+    bool rx_role_ok;             // Принят фрейм с ролью второго узла, rx_mac_own больше не нужен
+
+    // Очередь проверенных фреймов: заполняется в прерывании, разбирается в основном цикле
+    SecUartRxSlot rx_queue[SECUART_RX_QUEUE_LEN];
+    volatile uint32_t rx_q_head; // Сколько фреймов прошло проверку MAC
+    volatile uint32_t rx_q_tail; // Сколько фреймов отдано приложению
+    volatile bool rx_stalled;    // Разбор кольца приостановлен: очередь заполнена
+    volatile SecUartError rx_error; // Ошибка, обнаруженная в прерывании
+    uint16_t rx_agg_pos;         // Смещение следующего вложенного сообщения агрегата в первом слоте
+
+#if SECUART_BULK
+    // Длинные фреймы: на прием - пул буферов сборки, на передачу - один буфер
+    SecUartBulkBuffer rx_bulk_pool[SECUART_BULK_POOL_LEN];
+    SecUartBulkBuffer *rx_bulk_cur;   // Собирается прерыванием (после битого фрейма - переиспользуется)
+    SecUartBulkBuffer *rx_bulk_held;  // Отдан приложению до следующего SecUart_ProcessRxData
+    const uint8_t *rx_bulk_data;      // Данные последнего длинного сообщения (без типа)
+    uint16_t rx_bulk_size;
+    __ALIGNED(SECUART_BUFFER_ALIGN) uint8_t tx_bulk[SECUART_HEADER_SIZE_EXT + SECUART_BULK_MAX_SIZE + SECUART_MAC_SIZE];
+    volatile bool tx_bulk_busy;       // tx_bulk в очереди передачи
+#endif
+
+    // Очередь передачи: один производитель (SecUart_Send), один потребитель (TxCplt).
+    // Слоты [tx_q_tail, tx_q_head) принадлежат DMA, остальные - CPU.
+    SecUartTxSlot tx_queue[SECUART_TX_QUEUE_LEN];
+    volatile uint32_t tx_q_head; // Сколько фреймов поставлено в очередь
+    volatile uint32_t tx_q_tail; // Сколько фреймов полностью отправлено
+#if SECUART_TX_CUT_THROUGH
+    uint8_t tx_stage[SECUART_MAX_DATA_SIZE];  // Открытый текст сквозной передачи: слот уже читает DMA
+#endif
+
+#if SECUART_AGGREGATION
+    // Агрегат, который копит SecUart_Post (только основной цикл)
+    uint8_t agg_buf[SECUART_AGG_CAPACITY];  // Вложенные сообщения с подзаголовками
+    uint16_t agg_len;            // Занято байт в agg_buf
+    uint8_t agg_count;           // Сообщений в agg_buf
+    bool agg_flush_pending;      // Сброс не удался (очередь передачи полна) - повторить в SecUart_Poll
+    uint32_t agg_since;          // HAL_GetTick() первого сообщения агрегата
+    uint32_t agg_delay_ms;       // Сколько сообщение может ждать попутчиков, мс
+#endif
+
+#if SECUART_ARQ
+    // ARQ, передача: фреймы [arq_tx_base, arq_tx_next) ждут подтверждения
+    SecUartArqSlot arq_tx[SECUART_ARQ_WINDOW];  // Слот номера n - arq_tx[n & SECUART_ARQ_MASK]
+    uint8_t arq_tx_base;         // Старший неподтвержденный номер
+    uint8_t arq_tx_next;         // Номер следующего надежного фрейма
+    bool arq_tx_mark;            // Собираемый фрейм надежный (номер arq_tx_next)
+    bool arq_tx_syn;             // Номер 0 сеанса еще не подтвержден: в окне только он, с SECUART_FLAG_SYN
+    uint8_t arq_window;          // Окно, не больше SECUART_ARQ_WINDOW
+    uint32_t arq_timeout_ms;     // Повтор фрейма без подтверждения, мс
+
+    // ARQ, прием
+    uint8_t arq_rx_next;         // Все номера до него приняты
+    uint32_t arq_rx_map;         // Бит i - принят номер arq_rx_next + i
+    uint32_t arq_rx_cnt[SECUART_ARQ_WINDOW];  // CNT принятых фреймов окна
+    uint32_t arq_rx_base_cnt;    // CNT фрейма arq_rx_next - 1: более старые CNT окна - повтор
+    uint32_t arq_rx_top_cnt;     // Старший CNT принятых надежных фреймов: SYN новее него - новый сеанс узла
+    bool arq_rx_synced;          // Окно привязано к сеансу узла (принят надежный фрейм)
+    bool arq_ack_pending;        // Нужно отправить ACK/NACK (из SecUart_Poll)
+#endif
 
     // Счетчики
     uint32_t tx_counter;    // Счетчик отправленных пакетов
-    uint32_t rx_counter;    // Последний принятый счетчик
+#if SECUART_CNT_PERSIST
+    uint32_t tx_cnt_limit;  // Граница CNT во flash: CNT до нее можно использовать
+#endif
+    uint32_t tx_cnt_sync;   // CNT последнего фрейма с полным CNT (0 - еще не было)
+    uint32_t rx_counter;    // Старший принятый счетчик (CNT узла растет и через его перезапуски)
+    uint32_t rx_replay[SECUART_REPLAY_WORDS];  // Принятые CNT окна: бит CNT % 32 слова (CNT / 32) & SECUART_REPLAY_MASK
+    bool rx_counter_valid;  // Принят хотя бы один фрейм (CNT 0 тоже принимается один раз)
 
     // Флаги состояния
     volatile bool rx_complete;   // Флаг завершения приема
-    volatile bool tx_complete;   // Флаг завершения передачи
-
-    // Размеры данных
-    uint8_t rx_data_size;        // Размер принятых данных
+    volatile bool tx_complete;   // DMA передачи свободен (нет фрейма на линии)
 
     // Контекст шифрования
-    SpeckContext cipher_ctx;     // Контекст шифра Speck
+#if SECUART_SUITE_COUNT > 1
+    const SecUartSuite *suite;   // Набор алгоритмов канала
+#endif
+    const SpeckContext *cipher_ctx;  // Раундовые ключи Speck (во flash или в cipher_store)
+#if SECUART_RUNTIME_KEY
+    SpeckContext cipher_store;   // Ключи, развернутые в SecUart_Init
+#endif
+#if SECUART_SUITE_SIPHASH || SECUART_SUITE_HALFSIPHASH
+    uint8_t mac_key[SECUART_MAC_KEY_SIZE];  // Ключ MAC, выведенный из cipher_ctx при инициализации
+#endif
+    SecUartKeystream tx_ks[SECUART_KS_POOL_LEN];  // Гамма для следующих CNT передачи
+    SecUartKeystream rx_ks[SECUART_KS_POOL_LEN];  // Гамма для ожидаемых CNT приема
+    uint32_t tx_dir;             // Бит направления в блоке счетчика CTR передачи (SECUART_CTR_DIR_BIT или 0)
+    uint32_t rx_dir;             // То же для приема - роль узла на другом конце
+#if SECUART_LZ
+    // Сжатие: фрейм сжимается, только если становится короче. Длина фрейма
+    // выдает, насколько данные повторяют сами себя, - не сжимать данные, где
+    // секрет соседствует с тем, что может подобрать посторонний
+    bool tx_compress;            // Сжимать данные фреймов v2 (не короче SECUART_LZ_MIN), по умолчанию выключено
+    uint8_t rx_lz[SECUART_MAX_DATA_SIZE];  // Распакованные данные текущего фрейма
+    uint8_t rx_lz_len;
+#endif
 
     // Статистика
     uint32_t packets_sent;       // Отправлено пакетов
     uint32_t packets_received;   // Принято пакетов
     uint32_t errors_detected;    // Обнаружено ошибок
+    uint32_t rx_overruns;        // Потери данных из-за переполнения кольца
+    uint32_t rx_resyncs;         // Повторные поиски SOF после битых фреймов
+    uint32_t rx_bulk_dropped;    // Длинные фреймы, отброшенные без свободного буфера сборки
+    uint32_t rx_role_mismatch;   // Фреймы с MAC под ролью этого узла (SECUART_ERR_ROLE)
+    uint32_t tx_late;            // Сквозные передачи, где DMA обогнал шифрование
+    uint32_t arq_retransmits;    // Повторы надежных фреймов (тайм-аут или NACK)
 } SecUartContext;
 
+// Наборы алгоритмов, собранные в прошивку
+#if SECUART_SUITE_SPECK
+extern const SecUartSuite SecUart_SuiteSpeck;
+#endif
+#if SECUART_SUITE_SIPHASH
+extern const SecUartSuite SecUart_SuiteSipHash;
+#endif
+#if SECUART_SUITE_HALFSIPHASH
+extern const SecUartSuite SecUart_SuiteHalfSipHash;
+#endif
+#if SECUART_SUITE_CRC
+extern const SecUartSuite SecUart_SuiteCrc;
+#endif
+
+// Набор по умолчанию - первый из собранных (Speck, SipHash, HalfSipHash, CRC)
+#if SECUART_SUITE_SPECK
+#define SECUART_SUITE_DEFAULT   (&SecUart_SuiteSpeck)
+#elif SECUART_SUITE_SIPHASH
+#define SECUART_SUITE_DEFAULT   (&SecUart_SuiteSipHash)
+#elif SECUART_SUITE_HALFSIPHASH
+#define SECUART_SUITE_DEFAULT   (&SecUart_SuiteHalfSipHash)
+#else
+#define SECUART_SUITE_DEFAULT   (&SecUart_SuiteCrc)
+#endif
+
+/**
+ * @brief Инициализация с готовыми раундовыми ключами (например, secure_key_ctx во flash)
+ * @param ctx Указатель на структуру контекста
+ * @param huart_tx UART для передачи
+ * @param huart_rx UART для приема
+ * @param huart_monitor UART для мониторинга
+ * @param cipher Развернутый ключ; должен жить дольше ctx, не копируется
+ *               (может быть NULL для набора без шифрования)
+ * @param suite Набор алгоритмов канала (одна из таблиц SecUart_Suite*)
+ * @param role Роль узла; узел на другом конце линии должен иметь другую
+ * @return Код ошибки (SECUART_ERR_STORAGE - журнал CNT во flash недоступен)
+ */
+SecUartError SecUart_InitPrebuilt(SecUartContext *ctx,
+                         UART_HandleTypeDef *huart_tx,
+                         UART_HandleTypeDef *huart_rx,
+                         UART_HandleTypeDef *huart_monitor,
+                         const SpeckContext *cipher,
+                         const SecUartSuite *suite,
+                         SecUartRole role);
+
+#if SECUART_RUNTIME_KEY
 /**
  * @brief Инициализация контекста защищенного UART
  * @param ctx Указатель на структуру контекста
@@ -74,29 +503,144 @@ typedef struct {
  * @param huart_rx UART для приема
  * @param huart_monitor UART для мониторинга
  * @param key Ключ шифрования (4 слова по 32 бита)
+ * @param suite Набор алгоритмов канала (одна из таблиц SecUart_Suite*)
+ * @param role Роль узла; узел на другом конце линии должен иметь другую
  * @return Код ошибки
  */
 SecUartError SecUart_Init(SecUartContext *ctx,
                          UART_HandleTypeDef *huart_tx,
                          UART_HandleTypeDef *huart_rx,
                          UART_HandleTypeDef *huart_monitor,
-                         const uint32_t *key);
+                         const uint32_t *key,
+                         const SecUartSuite *suite,
+                         SecUartRole role);
+#endif
 
 /**
  * @brief Отправка данных через защищенный UART
+ * @note Фрейм ставится в очередь и уходит сразу после предыдущего без
+ *       участия основного цикла. Если очередь заполнена, возвращается
+ *       SECUART_ERR_BUFFER_OVERFLOW. Агрегат SecUart_Post, если он есть,
+ *       отправляется раньше - порядок сообщений сохраняется.
  * @param ctx Указатель на структуру контекста
  * @param data Указатель на данные для отправки
  * @param size Размер данных в байтах
  * @param msg_type Тип сообщения
- * @return Код ошибки
+ * @return Код ошибки. SECUART_ERR_TX_START - HAL не запустил DMA; фрейм
+ *         остается в очереди, повторно отправлять его не нужно
  */
 SecUartError SecUart_Send(SecUartContext *ctx,
                          const uint8_t *data,
                          uint8_t size,
                          SecUartMsgType msg_type);
 
+#if SECUART_AGGREGATION
+/**
+ * @brief Отправка сообщения с агрегацией
+ * @note Сообщение дописывается в агрегат и уходит вместе с соседями одним
+ *       фреймом SECUART_MSG_AGGREGATE (один заголовок, MAC и запуск DMA на
+ *       всех). Агрегат отправляется, когда следующее сообщение в него не
+ *       помещается, когда пришло срочное сообщение или когда первое
+ *       сообщение ждет дольше agg_delay_ms (см. SecUart_Poll). Агрегат из
+ *       одного сообщения уходит обычным фреймом.
+ * @param ctx Указатель на структуру контекста
+ * @param data Указатель на данные для отправки
+ * @param size Размер данных в байтах (как в SecUart_Send, с учетом типа)
+ * @param msg_type Тип сообщения
+ * @param urgent Отправить агрегат сразу вместе с этим сообщением
+ * @return SECUART_OK - сообщение принято (и, возможно, уже в очереди DMA);
+ *         SECUART_ERR_BUFFER_OVERFLOW - не принято, очередь передачи полна
+ */
+SecUartError SecUart_Post(SecUartContext *ctx,
+                         const uint8_t *data,
+                         uint8_t size,
+                         SecUartMsgType msg_type,
+                         bool urgent);
+
+/**
+ * @brief Немедленная отправка накопленного агрегата
+ * @param ctx Указатель на структуру контекста
+ * @return Код ошибки (SECUART_OK, если агрегат пуст)
+ */
+SecUartError SecUart_Flush(SecUartContext *ctx);
+#endif
+
+#if SECUART_ARQ
+/**
+ * @brief Надежная отправка (selective repeat)
+ * @note До arq_window фреймов могут ждать подтверждения одновременно. Узел
+ *       подтверждает их накопительным ACK, а пропуски сообщает NACK с
+ *       битовой картой; пропущенные фреймы и фреймы без подтверждения
+ *       дольше arq_timeout_ms повторяются из сохраненного шифротекста
+ *       (SecUart_Poll). Каждое сообщение доставляется приложению узла
+ *       ровно один раз, после потерь - не обязательно по порядку.
+ *       Первый надежный фрейм после инициализации уходит один, с флагом
+ *       SECUART_FLAG_SYN: по нему узел начинает окно приема заново (номера
+ *       ARQ после перезапуска снова идут с нуля), остальные ждут его ACK.
+ * @param ctx Указатель на структуру контекста
+ * @param data Указатель на данные для отправки
+ * @param size Размер данных в байтах (как в SecUart_Send, с учетом типа)
+ * @param msg_type Тип сообщения
+ * @return SECUART_ERR_BUFFER_OVERFLOW - окно или очередь передачи заполнены
+ */
+SecUartError SecUart_SendReliable(SecUartContext *ctx,
+                         const uint8_t *data,
+                         uint8_t size,
+                         SecUartMsgType msg_type);
+#endif
+
+#if SECUART_BULK
+/**
+ * @brief Отправка длинного сообщения одним фреймом
+ * @note Фрейм v2 с флагом SECUART_FLAG_EXT: LEN 16-битный (RSV - старший
+ *       байт), один заголовок и один MAC на все сообщение. За CNT в
+ *       заголовке идет ~LEN: ложный SOF или битый LEN не заставят приемник
+ *       ждать килобайты. Два нулевых байта за ~LEN держат данные на границе
+ *       слова, как у обычного фрейма v2. Фрейм шифруется в tx_bulk целиком и уходит одной
+ *       передачей DMA; следующий длинный фрейм можно отправить после ее
+ *       завершения. Длинный фрейм не надежный (ARQ хранит только обычные
+ *       фреймы) и не сжимается: при потере или битом байте сообщение
+ *       отправляют заново целиком. Сообщение не длиннее
+ *       SECUART_MAX_DATA_SIZE уходит обычным фреймом (SecUart_Send).
+ * @param ctx Указатель на структуру контекста
+ * @param data Указатель на данные для отправки
+ * @param size Размер данных в байтах (с учетом типа, до SECUART_BULK_MAX_SIZE)
+ * @param msg_type Тип сообщения
+ * @return SECUART_ERR_BUFFER_OVERFLOW - tx_bulk или очередь передачи заняты
+ */
+SecUartError SecUart_SendBulk(SecUartContext *ctx,
+                         const uint8_t *data,
+                         uint16_t size,
+                         SecUartMsgType msg_type);
+
+/**
+ * @brief Данные длинного сообщения, только что отданного SecUart_ProcessRxData
+ * @note SecUart_ProcessRxData возвращает для длинного фрейма тип и *size = 0,
+ *       сами данные не копируются: они остаются в буфере сборки до следующего
+ *       вызова SecUart_ProcessRxData. Если все буферы пула заняты, длинный
+ *       фрейм пропускается (rx_bulk_dropped), прием остальных не стоит.
+ * @param ctx Указатель на структуру контекста
+ * @param size Указатель на переменную для размера данных (без типа)
+ * @return Указатель на данные или NULL, если последнее сообщение обычное
+ */
+const uint8_t *SecUart_BulkData(const SecUartContext *ctx, uint16_t *size);
+#endif
+
+/**
+ * @brief Работа по таймеру (вызывать в основном цикле): сброс агрегата,
+ *        ACK/NACK на принятые надежные фреймы, повторы ARQ по тайм-ауту,
+ *        стирание старого сектора журнала CNT (SECUART_CNT_PERSIST)
+ * @param ctx Указатель на структуру контекста
+ */
+void SecUart_Poll(SecUartContext *ctx);
+
 /**
  * @brief Обработка принятых данных
+ * @note MAC и расшифрование выполняются в прерываниях приема по мере
+ *       поступления блоков; здесь фреймы только забираются из очереди,
+ *       по одному за вызов. Пока rx_complete установлен, в очереди есть
+ *       фреймы или ошибки. SECUART_ERR_TIMEOUT - готовых фреймов нет.
+ *       Агрегат отдается по одному вложенному сообщению за вызов.
  * @param ctx Указатель на структуру контекста
  * @param data Указатель на буфер для декодированных данных
  * @param size Указатель на переменную для размера данных
@@ -109,19 +653,65 @@ SecUartError SecUart_ProcessRxData(SecUartContext *ctx,
                                   SecUartMsgType *msg_type);
 
 /**
- * @brief Обработчик прерывания IDLE для UART
+ * @brief Проверка CNT по окну защиты от повтора
+ * @note Принимаются CNT больше старшего принятого и не принятые ранее CNT
+ *       не старше SECUART_REPLAY_WINDOW от него: фреймы, переставленные
+ *       конвейером или повторенные, не считаются атакой. Стоимость не
+ *       зависит от CNT и размера окна.
+ * @param ctx Указатель на структуру контекста
+ * @param counter CNT фрейма
+ * @return true - фрейм не повтор
+ */
+bool SecUart_ReplayCheck(const SecUartContext *ctx, uint32_t counter);
+
+/**
+ * @brief Отметка CNT принятого фрейма в окне защиты от повтора
+ * @note Вызывать только для фреймов, прошедших MAC и SecUart_ReplayCheck
+ *       (надежный фрейм - окно приема ARQ). Повтор ARQ может прийти с CNT
+ *       старше окна защиты от повтора - такой CNT не отмечается
+ * @param ctx Указатель на структуру контекста
+ * @param counter CNT фрейма
+ */
+void SecUart_ReplayUpdate(SecUartContext *ctx, uint32_t counter);
+
+/**
+ * @brief Обработчик событий приема (IDLE, половина и конец кольца DMA)
+ * @note Вызывается из прерывания: продвигает rx_head и сразу пропускает
+ *       новые блоки через MAC и расшифрование
  * @param ctx Указатель на структуру контекста
  * @param huart Дескриптор UART, вызвавшего прерывание
  */
-void SecUart_RxIdleCallback(SecUartContext *ctx, UART_HandleTypeDef *huart);
+void SecUart_RxEventCallback(SecUartContext *ctx, UART_HandleTypeDef *huart);
+
+/**
+ * @brief Обработчик завершения передачи по DMA (запускает следующий фрейм очереди)
+ * @param ctx Указатель на структуру контекста
+ * @param huart Дескриптор UART, вызвавшего прерывание
+ */
+void SecUart_TxCpltCallback(SecUartContext *ctx, UART_HandleTypeDef *huart);
+
+/**
+ * @brief Обработчик ошибок UART (перезапускает прием/передачу после сброса HAL)
+ * @param ctx Указатель на структуру контекста
+ * @param huart Дескриптор UART, вызвавшего ошибку
+ */
+void SecUart_ErrorCallback(SecUartContext *ctx, UART_HandleTypeDef *huart);
 
 /**
- * @brief Запуск приема по DMA
+ * @brief Запуск непрерывного приема по циклическому DMA в кольцевой буфер
  * @param ctx Указатель на структуру контекста
  * @return Код ошибки
  */
 SecUartError SecUart_StartReceive(SecUartContext *ctx);
 
+/**
+ * @brief Предварительный расчет гаммы CTR для следующих фреймов (вызывать в простое)
+ * @param ctx Указатель на структуру контекста
+ * @param max_blocks Максимум блоков Speck за вызов
+ * @return Количество посчитанных блоков (0 - пул заполнен)
+ */
+uint16_t SecUart_PrecomputeKeystream(SecUartContext *ctx, uint16_t max_blocks);
+
 /**
  * @brief Отправка отладочного сообщения через монитор
  * @param ctx Указатель на структуру контекста
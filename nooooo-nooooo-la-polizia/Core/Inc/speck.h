@@ -4,6 +4,12 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// 1 - полностью развернутые раунды (x/y в регистрах), 0 - компактный цикл.
+// Развернутые ядра включает сборка (-DSPECK_UNROLLED=1) вместе с оптимизацией
+#ifndef SPECK_UNROLLED
+#define SPECK_UNROLLED 0
+#endif
+
 /**
  * @brief Контекст для шифра Speck 64/128
  * Размер блока 64 бита (2x32 бит), размер ключа 128 бит (4x32 бит)
@@ -12,6 +18,16 @@ typedef struct {
     uint32_t round_keys[27]; // Ключи для 27 раундов алгоритма Speck 64/128
 } SpeckContext;
 
+/**
+ * @brief Состояние потокового вычисления CBC-MAC
+ * Хранит цепочку CBC (64 бита) и неполный блок, кучу не использует
+ */
+typedef struct {
+    uint32_t state[2];       // Текущее значение цепочки CBC
+    uint8_t buffer[8];       // Накопленные байты неполного блока
+    size_t buffer_len;       // Количество байт в buffer
+} SpeckMacContext;
+
 /**
  * @brief Инициализация контекста шифрования
  * @param ctx Указатель на структуру контекста
@@ -42,4 +58,36 @@ void speck_decrypt(const SpeckContext *ctx, uint32_t *block);
  */
 void speck_mac(const SpeckContext *ctx, const uint8_t *data, size_t len, uint8_t *mac);
 
+/**
+ * @brief Цепочка CBC-MAC по полным блокам (big-endian), без буферизации
+ * @param ctx Указатель на инициализированный контекст
+ * @param state Цепочка CBC (2 слова)
+ * @param data Указатель на данные (nblocks * 8 байт)
+ * @param nblocks Количество блоков
+ */
+void speck_mac_blocks(const SpeckContext *ctx, uint32_t *state, const uint8_t *data, size_t nblocks);
+
+/**
+ * @brief Начало потокового вычисления MAC
+ * @param mac_ctx Указатель на состояние MAC
+ */
+void speck_mac_init(SpeckMacContext *mac_ctx);
+
+/**
+ * @brief Добавление очередной порции данных в MAC
+ * @param ctx Указатель на инициализированный контекст
+ * @param mac_ctx Указатель на состояние MAC
+ * @param data Указатель на данные (порции могут быть любой длины)
+ * @param len Длина порции в байтах
+ */
+void speck_mac_update(const SpeckContext *ctx, SpeckMacContext *mac_ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Завершение вычисления MAC (дополнение нулями до блока)
+ * @param ctx Указатель на инициализированный контекст
+ * @param mac_ctx Указатель на состояние MAC
+ * @param mac Указатель на буфер для записи MAC (8 байт)
+ */
+void speck_mac_final(const SpeckContext *ctx, SpeckMacContext *mac_ctx, uint8_t *mac);
+
 #endif // SPECK_H
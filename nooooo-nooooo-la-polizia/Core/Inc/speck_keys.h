@@ -0,0 +1,21 @@
+/**
+ * @file speck_keys.h
+ * @brief Раундовые ключи, развернутые при сборке (Tools/speck_keygen)
+ */
+
+#ifndef SPECK_KEYS_H
+#define SPECK_KEYS_H
+
+#include "speck.h"
+
+/**
+ * @brief Контекст Speck для ключа канала, лежит во flash
+ */
+extern const SpeckContext secure_key_ctx;
+
+/**
+ * @brief Раундовые ключи в порядке расшифрования (для ядер, идущих по таблице вперед)
+ */
+extern const uint32_t secure_key_dec[27];
+
+#endif // SPECK_KEYS_H
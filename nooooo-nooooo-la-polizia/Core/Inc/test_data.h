@@ -0,0 +1,17 @@
+/**
+ * @file test_data.h
+ * @brief Тестовые сообщения 8..128 байт: отправка из main.c и сверка ядер Speck на хосте
+ */
+
+#ifndef TEST_DATA_H_
+#define TEST_DATA_H_
+
+#include <stdint.h>
+
+extern uint8_t test_dataXS[8];
+extern uint8_t test_dataS[16];
+extern uint8_t test_dataM[32];
+extern uint8_t test_dataL[64];
+extern uint8_t test_dataXL[128];
+
+#endif /* TEST_DATA_H_ */
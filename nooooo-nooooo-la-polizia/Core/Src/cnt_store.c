@@ -0,0 +1,172 @@
+/**
+ * @file cnt_store.c
+ * @brief Хранение границы CNT передачи во flash между перезапусками
+ */
+
+#include "cnt_store.h"
+
+// Секторы журнала по номеру 0/1
+static const uint32_t cnt_store_addr[2] = { CNT_STORE_ADDR_A, CNT_STORE_ADDR_B };
+static const uint32_t cnt_store_sector[2] = { CNT_STORE_SECTOR_A, CNT_STORE_SECTOR_B };
+
+static uint8_t cnt_store_active;     // Сектор, куда идут записи
+static uint32_t cnt_store_next;      // Первое слово активного сектора после последней записи
+static uint32_t cnt_store_value;     // Сохраненная граница
+static bool cnt_store_dirty;         // Неактивный сектор не стерт
+
+static void CntStore_Scan(uint8_t s, uint32_t *max, uint32_t *used);
+static bool CntStore_Program(uint8_t s, uint32_t index, uint32_t value);
+static bool CntStore_Erase(uint8_t s);
+static bool CntStore_Move(uint32_t value);
+
+/**
+ * @brief Чтение сохраненной границы
+ */
+bool CntStore_Load(uint32_t *value) {
+	uint32_t max[2];
+	uint32_t used[2];
+
+	CntStore_Scan(0, &max[0], &used[0]);
+	CntStore_Scan(1, &max[1], &used[1]);
+
+	// Активный - сектор с наибольшей границей. Равные границы остаются после
+	// сброса посреди переноса: тогда активен новый сектор, в нем одна запись
+	if (max[1] > max[0] || (max[1] == max[0] && used[1] != 0 && used[1] < used[0])) {
+		cnt_store_active = 1;
+	} else {
+		cnt_store_active = 0;
+	}
+	cnt_store_next = used[cnt_store_active];
+	cnt_store_value = max[cnt_store_active];
+	*value = cnt_store_value;
+
+	// Неактивный сектор стирается здесь, пока UART еще не запущен
+	cnt_store_dirty = used[cnt_store_active ^ 1] != 0;
+	return CntStore_Service();
+}
+
+/**
+ * @brief Запись новой границы
+ */
+bool CntStore_Save(uint32_t value) {
+	if (value == CNT_STORE_EMPTY || value <= cnt_store_value) {
+		return false;
+	}
+
+	if (cnt_store_next >= CNT_STORE_WORDS) {
+		return CntStore_Move(value);
+	}
+
+	// Слово после неудачной записи уже не стерто - в любом случае идем дальше
+	uint32_t index = cnt_store_next++;
+	if (!CntStore_Program(cnt_store_active, index, value)) {
+		return false;
+	}
+
+	cnt_store_value = value;
+	return true;
+}
+
+/**
+ * @brief Ждет ли неактивный сектор стирания
+ */
+bool CntStore_Pending(void) {
+	return cnt_store_dirty;
+}
+
+/**
+ * @brief Стирание неактивного сектора после переноса
+ */
+bool CntStore_Service(void) {
+	if (!cnt_store_dirty) {
+		return true;
+	}
+	if (!CntStore_Erase(cnt_store_active ^ 1)) {
+		return false;
+	}
+
+	cnt_store_dirty = false;
+	return true;
+}
+
+/**
+ * @brief Наибольшая граница сектора и число слов до последней записи
+ * @note Слово, недописанное при сбросе, может только превышать записываемое
+ *       (запись лишь сбрасывает биты), поэтому берется как есть
+ */
+static void CntStore_Scan(uint8_t s, uint32_t *max, uint32_t *used) {
+	const volatile uint32_t *words = (const volatile uint32_t *)(uintptr_t)cnt_store_addr[s];
+
+	*max = 0;
+	*used = 0;
+	for (uint32_t i = 0; i < CNT_STORE_WORDS; i++) {
+		uint32_t w = words[i];
+
+		if (w != CNT_STORE_EMPTY) {
+			if (w > *max) {
+				*max = w;
+			}
+			*used = i + 1;
+		}
+	}
+}
+
+/**
+ * @brief Запись слова журнала с проверкой чтением
+ */
+static bool CntStore_Program(uint8_t s, uint32_t index, uint32_t value) {
+	uint32_t addr = cnt_store_addr[s] + index * 4;
+
+	HAL_FLASH_Unlock();
+	HAL_StatusTypeDef status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr, value);
+	HAL_FLASH_Lock();
+
+	// Кеш данных ART не видит записи - иначе проверка прочитала бы старое слово
+	FLASH_FlushCaches();
+
+	return status == HAL_OK && *(const volatile uint32_t *)(uintptr_t)addr == value;
+}
+
+/**
+ * @brief Стирание сектора журнала
+ */
+static bool CntStore_Erase(uint8_t s) {
+	FLASH_EraseInitTypeDef erase = {
+		.TypeErase = FLASH_TYPEERASE_SECTORS,
+		.Sector = cnt_store_sector[s],
+		.NbSectors = 1,
+		.VoltageRange = FLASH_VOLTAGE_RANGE_3,
+	};
+	uint32_t bad_sector;
+
+	HAL_FLASH_Unlock();
+	HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &bad_sector);
+	HAL_FLASH_Lock();
+
+	return status == HAL_OK;
+}
+
+/**
+ * @brief Перенос журнала в другой сектор с границей value
+ * @note Без стирания: другой сектор должен быть уже стерт CntStore_Service.
+ *       Старый сектор остается до следующего CntStore_Service - при сбросе
+ *       в любой момент во flash остается граница не меньше прежней
+ */
+static bool CntStore_Move(uint32_t value) {
+	uint8_t other = cnt_store_active ^ 1;
+
+	if (cnt_store_dirty) {
+		return false;
+	}
+	if (!CntStore_Program(other, 0, value)) {
+		// Слово могло записаться частично - сектор снова требует стирания
+		cnt_store_dirty = true;
+		return false;
+	}
+
+	cnt_store_active = other;
+	cnt_store_next = 1;
+	cnt_store_value = value;
+	cnt_store_dirty = true;
+	return true;
+}
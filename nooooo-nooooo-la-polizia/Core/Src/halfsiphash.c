@@ -0,0 +1,145 @@
+/**
+ * @file halfsiphash.c
+ * @brief Реализация алгоритма HalfSipHash-2-4 для генерации MAC
+ */
+
+#include "halfsiphash.h"
+
+/* Макрос для циклического сдвига влево (одна инструкция ROR на Cortex-M) */
+#define ROTL32(x, r) (((x) << (r)) | ((x) >> (32 - (r))))
+
+/* Макрос для преобразования 4 байт в 32-битное слово (little-endian) */
+#define U8TO32_LE(p) \
+    (((uint32_t)((p)[0])) | \
+     ((uint32_t)((p)[1]) << 8) | \
+     ((uint32_t)((p)[2]) << 16) | \
+     ((uint32_t)((p)[3]) << 24))
+
+/* Макрос для преобразования 32-битного слова в 4 байта (little-endian) */
+#define U32TO8_LE(p, v) \
+    do { \
+        (p)[0] = (uint8_t)((v)); \
+        (p)[1] = (uint8_t)((v) >> 8); \
+        (p)[2] = (uint8_t)((v) >> 16); \
+        (p)[3] = (uint8_t)((v) >> 24); \
+    } while (0)
+
+/* HalfSipHash раунд */
+#define HSIPROUND \
+    do { \
+        v0 += v1; v1 = ROTL32(v1, 5); v1 ^= v0; v0 = ROTL32(v0, 16); \
+        v2 += v3; v3 = ROTL32(v3, 8); v3 ^= v2; \
+        v0 += v3; v3 = ROTL32(v3, 7); v3 ^= v0; \
+        v2 += v1; v1 = ROTL32(v1, 13); v1 ^= v2; v2 = ROTL32(v2, 16); \
+    } while (0)
+
+/**
+ * @brief Сжатие последовательности полных слов
+ */
+static void halfsiphash_compress(HalfSipHashContext* ctx, const uint8_t* data, size_t words) {
+    uint32_t v0 = ctx->v0, v1 = ctx->v1, v2 = ctx->v2, v3 = ctx->v3;
+
+    for (size_t w = 0; w < words; w++, data += 4) {
+        uint32_t m = U8TO32_LE(data);
+        v3 ^= m;
+
+        /* Сжимающие раунды */
+        for (int i = 0; i < HALFSIPHASH_CROUND; i++) {
+            HSIPROUND;
+        }
+
+        v0 ^= m;
+    }
+
+    ctx->v0 = v0; ctx->v1 = v1; ctx->v2 = v2; ctx->v3 = v3;
+}
+
+void HalfSipHash_Init(HalfSipHashContext* ctx, const uint8_t* key) {
+    const uint32_t k0 = U8TO32_LE(key);
+    const uint32_t k1 = U8TO32_LE(key + 4);
+
+    /* Инициализация состояния, 0xee в v1 - признак 64-битного выхода */
+    ctx->v0 = k0;
+    ctx->v1 = k1 ^ 0xee;
+    ctx->v2 = 0x6c796765 ^ k0;
+    ctx->v3 = 0x74656462 ^ k1;
+    ctx->tail = 0;
+    ctx->len = 0;
+}
+
+void HalfSipHash_Update(HalfSipHashContext* ctx, const uint8_t* data, size_t len) {
+    unsigned fill = ctx->len & 3;
+    ctx->len += (uint32_t)len;
+
+    /* Дополняем неполное слово, оставшееся от прошлой порции */
+    if (fill != 0) {
+        while (fill < 4 && len > 0) {
+            ctx->tail |= (uint32_t)*data++ << (8 * fill++);
+            len--;
+        }
+        if (fill < 4) {
+            return;
+        }
+
+        uint8_t word[4];
+        U32TO8_LE(word, ctx->tail);
+        halfsiphash_compress(ctx, word, 1);
+        ctx->tail = 0;
+    }
+
+    /* Полные слова - прямо из буфера данных */
+    halfsiphash_compress(ctx, data, len / 4);
+    data += len & ~(size_t)3;
+
+    for (unsigned i = 0; i < (len & 3); i++) {
+        ctx->tail |= (uint32_t)data[i] << (8 * i);
+    }
+}
+
+void HalfSipHash_Final(HalfSipHashContext* ctx, uint8_t* out) {
+    uint32_t v0 = ctx->v0, v1 = ctx->v1, v2 = ctx->v2, v3 = ctx->v3;
+
+    /* Последний блок: младший байт длины и хвост сообщения */
+    uint32_t b = (ctx->len << 24) | ctx->tail;
+
+    v3 ^= b;
+
+    /* Сжимающие раунды для последнего блока */
+    for (int i = 0; i < HALFSIPHASH_CROUND; i++) {
+        HSIPROUND;
+    }
+
+    v0 ^= b;
+
+    /* Финализирующие раунды, первая половина MAC */
+    v2 ^= 0xee;
+    for (int i = 0; i < HALFSIPHASH_FROUND; i++) {
+        HSIPROUND;
+    }
+    b = v1 ^ v3;
+    U32TO8_LE(out, b);
+
+    /* Вторая половина MAC */
+    v1 ^= 0xdd;
+    for (int i = 0; i < HALFSIPHASH_FROUND; i++) {
+        HSIPROUND;
+    }
+    b = v1 ^ v3;
+    U32TO8_LE(out + 4, b);
+}
+
+uint64_t HalfSipHash_2_4(const uint8_t* key, const uint8_t* data, size_t len) {
+    uint8_t out[HALFSIPHASH_MAC_SIZE];
+
+    HalfSipHash_2_4_MAC(key, data, len, out);
+
+    return (uint64_t)U8TO32_LE(out) | ((uint64_t)U8TO32_LE(out + 4) << 32);
+}
+
+void HalfSipHash_2_4_MAC(const uint8_t* key, const uint8_t* data, size_t len, uint8_t* out) {
+    HalfSipHashContext ctx;
+
+    HalfSipHash_Init(&ctx, key);
+    HalfSipHash_Update(&ctx, data, len);
+    HalfSipHash_Final(&ctx, out);
+}
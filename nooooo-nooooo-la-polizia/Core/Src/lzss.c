@@ -0,0 +1,123 @@
+/**
+ * @file lzss.c
+ * @brief Сжатие LZSS для данных одного фрейма
+ */
+
+#include "lzss.h"
+#include <string.h>
+
+/* Хеш трех байт: одно умножение (Фибоначчи), старшие биты - индекс */
+#define LZSS_HASH(p) \
+    ((((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | ((uint32_t)(p)[2] << 16)) * 2654435761u) >> (32 - LZSS_HASH_BITS))
+
+/**
+ * @brief Сжатие данных
+ */
+size_t Lzss_Compress(const uint8_t* in, size_t len, uint8_t* out, size_t out_max) {
+    uint8_t head[1 << LZSS_HASH_BITS];   // Последняя позиция + 1 для хеша, 0 - пусто
+    size_t ip = 0, op = 0;
+    size_t ctrl_pos = 0;
+    uint8_t bit = 8;                     // Элементов в текущей группе
+
+    if (len == 0 || len > LZSS_MAX_INPUT) {
+        return 0;
+    }
+
+    memset(head, 0, sizeof(head));
+
+    while (ip < len) {
+        // Новая группа - место под управляющий байт
+        if (bit == 8) {
+            if (op >= out_max) {
+                return 0;
+            }
+            ctrl_pos = op++;
+            out[ctrl_pos] = 0;
+            bit = 0;
+        }
+
+        size_t match_len = 0;
+        size_t match_pos = 0;
+
+        if (ip + LZSS_MIN_MATCH <= len) {
+            uint32_t h = LZSS_HASH(in + ip);
+            size_t cand = head[h];
+            head[h] = (uint8_t)(ip + 1);
+
+            // Одна проба без цепочек: на коротких фреймах цепочки почти ничего не дают
+            if (cand != 0) {
+                match_pos = cand - 1;
+                size_t limit = len - ip;
+                if (limit > LZSS_MAX_MATCH) {
+                    limit = LZSS_MAX_MATCH;
+                }
+                while (match_len < limit && in[match_pos + match_len] == in[ip + match_len]) {
+                    match_len++;
+                }
+            }
+        }
+
+        if (match_len >= LZSS_MIN_MATCH) {
+            if (op + 2 > out_max) {
+                return 0;
+            }
+            out[ctrl_pos] |= (uint8_t)(1u << bit);
+            out[op++] = (uint8_t)(ip - match_pos - 1);
+            out[op++] = (uint8_t)(match_len - LZSS_MIN_MATCH);
+
+            // Позиции внутри совпадения тоже попадают в таблицу
+            for (size_t p = ip + 1; p < ip + match_len && p + LZSS_MIN_MATCH <= len; p++) {
+                head[LZSS_HASH(in + p)] = (uint8_t)(p + 1);
+            }
+            ip += match_len;
+        } else {
+            if (op >= out_max) {
+                return 0;
+            }
+            out[op++] = in[ip++];
+        }
+        bit++;
+    }
+
+    return op;
+}
+
+/**
+ * @brief Распаковка данных
+ */
+size_t Lzss_Decompress(const uint8_t* in, size_t len, uint8_t* out, size_t out_max) {
+    size_t ip = 0, op = 0;
+
+    while (ip < len) {
+        uint8_t ctrl = in[ip++];
+
+        for (uint8_t bit = 0; bit < 8 && ip < len; bit++) {
+            if (ctrl & (1u << bit)) {
+                if (ip + 2 > len) {
+                    return 0;
+                }
+                size_t offset = (size_t)in[ip] + 1;
+                size_t n = (size_t)in[ip + 1] + LZSS_MIN_MATCH;
+                ip += 2;
+
+                if (offset > op || n > out_max - op) {
+                    return 0;
+                }
+
+                // Побайтно: совпадение может перекрывать само себя (повтор серии)
+                const uint8_t* src = out + op - offset;
+                for (size_t i = 0; i < n; i++) {
+                    out[op + i] = src[i];
+                }
+                op += n;
+            } else {
+                if (op >= out_max) {
+                    return 0;
+                }
+                out[op++] = in[ip++];
+            }
+        }
+    }
+
+    return op;
+}
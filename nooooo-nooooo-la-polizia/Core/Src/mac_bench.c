@@ -0,0 +1,282 @@
+/**
+ * @file mac_bench.c
+ * @brief Сравнение стоимости MAC фрейма: Speck CBC-MAC, HalfSipHash, SipHash;
+ *        стоимость окна защиты от повтора; сжатие данных LZSS
+ */
+
+#include "mac_bench.h"
+#include "secure_uart.h"
+#include "siphash.h"
+#include "halfsiphash.h"
+#include <string.h>
+#include <stdio.h>
+
+#define MAC_BENCH_RUNS             8                   // Прогонов на размер, берется минимум
+
+// Алгоритмы в порядке столбцов таблицы
+typedef enum {
+    MAC_BENCH_SPECK = 0,
+    MAC_BENCH_HALFSIP24,
+    MAC_BENCH_SIP13,
+    MAC_BENCH_SIP24,
+    MAC_BENCH_COUNT
+} MacBenchAlgo;
+
+static const uint8_t bench_payloads[] = { 8, 16, 32, 64, 128, 255 };
+
+/**
+ * @brief Один MAC выбранным алгоритмом, такты DWT
+ */
+static uint32_t MacBench_Measure(MacBenchAlgo algo, const SpeckContext *cipher, const uint8_t *key,
+		const uint8_t *frame, uint16_t len) {
+	uint8_t mac[SECUART_MAC_SIZE];
+	uint32_t t0 = DWT->CYCCNT;
+
+	switch (algo) {
+	case MAC_BENCH_SPECK:
+		speck_mac(cipher, frame, len, mac);
+		break;
+	case MAC_BENCH_HALFSIP24:
+		HalfSipHash_2_4_MAC(key, frame, len, mac);
+		break;
+	case MAC_BENCH_SIP13:
+		SipHash_1_3_MAC(key, frame, len, mac);
+		break;
+	default:
+		SipHash_2_4_MAC(key, frame, len, mac);
+		break;
+	}
+
+	uint32_t cycles = DWT->CYCCNT - t0;
+
+	// Не даем компилятору выбросить вычисление
+	__asm volatile ("" : : "r" (mac[0]) : "memory");
+
+	return cycles;
+}
+
+/**
+ * @brief Замер тактов на MAC фрейма для всех алгоритмов и размеров
+ */
+void MacBench_Run(UART_HandleTypeDef *huart, const SpeckContext *cipher) {
+	static uint8_t frame[SECUART_BUFFER_SIZE];
+	uint8_t key[SIPHASH_KEY_SIZE];
+	char line[96];
+
+	for (uint16_t i = 0; i < sizeof(frame); i++) {
+		frame[i] = (uint8_t)(i * 37 + 11);
+	}
+	for (uint8_t i = 0; i < sizeof(key); i++) {
+		key[i] = i;
+	}
+
+	snprintf(line, sizeof(line), "MAC cycles/frame: payload  speck  hsip24  sip13  sip24\r\n");
+	HAL_UART_Transmit(huart, (uint8_t*)line, strlen(line), 100);
+
+	for (uint8_t p = 0; p < sizeof(bench_payloads); p++) {
+		// MAC покрывает заголовок и данные фрейма
+		uint16_t len = SECUART_HEADER_SIZE_V2 + bench_payloads[p];
+		uint32_t best[MAC_BENCH_COUNT];
+
+		for (int a = 0; a < MAC_BENCH_COUNT; a++) {
+			best[a] = UINT32_MAX;
+			for (int r = 0; r < MAC_BENCH_RUNS; r++) {
+				uint32_t cycles = MacBench_Measure((MacBenchAlgo)a, cipher, key, frame, len);
+				if (cycles < best[a]) {
+					best[a] = cycles;
+				}
+			}
+		}
+
+		snprintf(line, sizeof(line), "                  %7u %6lu %7lu %6lu %6lu\r\n",
+				bench_payloads[p], best[MAC_BENCH_SPECK], best[MAC_BENCH_HALFSIP24],
+				best[MAC_BENCH_SIP13], best[MAC_BENCH_SIP24]);
+		HAL_UART_Transmit(huart, (uint8_t*)line, strlen(line), 100);
+	}
+}
+
+// Последовательности CNT для замера окна защиты от повтора
+typedef enum {
+	REPLAY_BENCH_IN_ORDER = 0,   // 1, 2, 3, ...
+	REPLAY_BENCH_REORDER,        // Группы по 16 в обратном порядке
+	REPLAY_BENCH_JUMP,           // Каждый CNT дальше окна от предыдущего
+	REPLAY_BENCH_REPLAY,         // Один и тот же CNT
+	REPLAY_BENCH_COUNT
+} ReplayBenchPattern;
+
+static const char *const replay_bench_names[REPLAY_BENCH_COUNT] = {
+	"in order", "reorder", "jump", "replay"
+};
+
+/**
+ * @brief CNT i-го фрейма последовательности
+ */
+static uint32_t ReplayBench_Counter(ReplayBenchPattern pattern, uint32_t i) {
+	switch (pattern) {
+	case REPLAY_BENCH_IN_ORDER:
+		return i + 1;
+	case REPLAY_BENCH_REORDER:
+		return (i | 15) - (i & 15) + 1;
+	case REPLAY_BENCH_JUMP:
+		return (i + 1) * (3 * SECUART_REPLAY_WINDOW);
+	default:
+		return 1;
+	}
+}
+
+/**
+ * @brief Замер тактов на проверку и отметку CNT для всех последовательностей
+ */
+void MacBench_Replay(UART_HandleTypeDef *huart) {
+	static SecUartContext ctx;                        // Нужны только поля окна
+	char line[96];
+
+	snprintf(line, sizeof(line), "Replay window %u, cycles/frame: min  max\r\n", SECUART_REPLAY_WINDOW);
+	HAL_UART_Transmit(huart, (uint8_t*)line, strlen(line), 100);
+
+	for (int p = 0; p < REPLAY_BENCH_COUNT; p++) {
+		uint32_t best = UINT32_MAX, worst = 0;
+
+		ctx.rx_counter_valid = false;
+		for (uint32_t i = 0; i < 1024; i++) {
+			uint32_t counter = ReplayBench_Counter((ReplayBenchPattern)p, i);
+			uint32_t t0 = DWT->CYCCNT;
+
+			if (SecUart_ReplayCheck(&ctx, counter)) {
+				SecUart_ReplayUpdate(&ctx, counter);
+			}
+
+			uint32_t cycles = DWT->CYCCNT - t0;
+
+			// Первый фрейм сбрасывает окно целиком - его не считаем
+			if (i == 0) {
+				continue;
+			}
+			if (cycles < best) {
+				best = cycles;
+			}
+			if (cycles > worst) {
+				worst = cycles;
+			}
+		}
+
+		snprintf(line, sizeof(line), "  %-10s %19lu %4lu\r\n", replay_bench_names[p], best, worst);
+		HAL_UART_Transmit(huart, (uint8_t*)line, strlen(line), 100);
+	}
+}
+
+#if SECUART_LZ
+// Типичные данные фрейма для замера сжатия
+typedef enum {
+	LZ_BENCH_TEXT = 0,           // Текстовая телеметрия
+	LZ_BENCH_JSON,               // Статус в JSON
+	LZ_BENCH_SAMPLES,            // Медленно меняющиеся отсчеты int16
+	LZ_BENCH_RANDOM,             // Случайные байты (не сжимаются)
+	LZ_BENCH_COUNT
+} LzBenchPayload;
+
+static const char *const lz_bench_names[LZ_BENCH_COUNT] = {
+	"text", "json", "samples", "random"
+};
+
+/**
+ * @brief Заполнение данных выбранного вида, возвращает длину
+ */
+static uint8_t LzBench_Fill(LzBenchPayload kind, uint8_t *buf) {
+	uint8_t len = 0;
+
+	switch (kind) {
+	case LZ_BENCH_TEXT:
+		for (int i = 0; i < 6; i++) {
+			len += snprintf((char*)buf + len, SECUART_MAX_DATA_SIZE - len,
+					"T%d=%d.%dC V=3.%02dV OK\r\n", i, 21 + i % 2, i * 3 % 10, 28 + i);
+		}
+		break;
+	case LZ_BENCH_JSON:
+		len = snprintf((char*)buf, SECUART_MAX_DATA_SIZE,
+				"{\"id\":17,\"state\":\"run\",\"temp\":[21.5,21.6,21.6,21.7],"
+				"\"volt\":[3.30,3.29,3.30,3.31],\"err\":0,\"uptime\":123456,"
+				"\"flags\":{\"fan\":true,\"heat\":false,\"door\":false}}");
+		break;
+	case LZ_BENCH_SAMPLES:
+		for (int i = 0; i < 100; i++) {
+			int16_t v = (int16_t)(1000 + i / 8);
+			buf[len++] = (uint8_t)v;
+			buf[len++] = (uint8_t)(v >> 8);
+		}
+		break;
+	default:
+		for (uint32_t i = 0, x = 0x9E3779B9u; i < 200; i++) {
+			x ^= x << 13;
+			x ^= x >> 17;
+			x ^= x << 5;
+			buf[len++] = (uint8_t)x;
+		}
+		break;
+	}
+
+	return len;
+}
+
+/**
+ * @brief Замер степени сжатия и тактов на байт сжатия и распаковки
+ */
+void MacBench_Compress(UART_HandleTypeDef *huart) {
+	static uint8_t in[SECUART_MAX_DATA_SIZE];
+	static uint8_t packed[SECUART_MAX_DATA_SIZE];
+	static uint8_t out[SECUART_MAX_DATA_SIZE];
+	char line[96];
+
+	snprintf(line, sizeof(line), "LZSS: payload  size  packed  ratio  comp c/B  decomp c/B\r\n");
+	HAL_UART_Transmit(huart, (uint8_t*)line, strlen(line), 100);
+
+	for (int p = 0; p < LZ_BENCH_COUNT; p++) {
+		uint8_t len = LzBench_Fill((LzBenchPayload)p, in);
+		uint32_t comp = UINT32_MAX, decomp = UINT32_MAX;
+		size_t packed_len = 0;
+		size_t out_len = 0;
+
+		for (int r = 0; r < MAC_BENCH_RUNS; r++) {
+			uint32_t t0 = DWT->CYCCNT;
+			packed_len = Lzss_Compress(in, len, packed, sizeof(packed));
+			uint32_t cycles = DWT->CYCCNT - t0;
+			if (cycles < comp) {
+				comp = cycles;
+			}
+
+			if (packed_len != 0) {
+				t0 = DWT->CYCCNT;
+				out_len = Lzss_Decompress(packed, packed_len, out, sizeof(out));
+				cycles = DWT->CYCCNT - t0;
+				if (cycles < decomp) {
+					decomp = cycles;
+				}
+			}
+		}
+
+		// Распакованное должно совпасть с исходным, иначе замер не имеет смысла
+		if (packed_len != 0 && (out_len != len || memcmp(out, in, len) != 0)) {
+			snprintf(line, sizeof(line), "      %-8s FAIL: round trip mismatch\r\n", lz_bench_names[p]);
+			HAL_UART_Transmit(huart, (uint8_t*)line, strlen(line), 100);
+			continue;
+		}
+
+		// Не сжалось - фрейм уйдет как есть, распаковки нет (вместо тактов "-")
+		char decomp_str[16];
+		if (packed_len == 0 || packed_len >= len) {
+			packed_len = len;
+			snprintf(decomp_str, sizeof(decomp_str), "%11s", "-");
+		} else {
+			snprintf(decomp_str, sizeof(decomp_str), "%8lu.%02lu", decomp / len, decomp * 100 / len % 100);
+		}
+
+		// Степень и такты на исходный байт с двумя знаками после запятой
+		snprintf(line, sizeof(line), "      %-8s %5u %7u  %lu.%02lu %6lu.%02lu %s\r\n",
+				lz_bench_names[p], len, (unsigned)packed_len,
+				(uint32_t)(packed_len / len), (uint32_t)(packed_len * 100 / len % 100),
+				comp / len, comp * 100 / len % 100,
+				decomp_str);
+		HAL_UART_Transmit(huart, (uint8_t*)line, strlen(line), 100);
+	}
+}
+#endif
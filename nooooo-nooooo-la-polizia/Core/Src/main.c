@@ -13,6 +13,9 @@
 /* USER CODE BEGIN Includes */
 #include "secure_uart.h"
 #include "speck.h"
+#include "speck_keys.h"
+#include "mac_bench.h"
+#include "test_data.h"
 #include <string.h>
 #include <stdio.h>
 /* USER CODE END Includes */
@@ -45,34 +48,12 @@ DMA_HandleTypeDef hdma_usart6_rx;
 DMA_HandleTypeDef hdma_usart6_tx;
 
 /* USER CODE BEGIN PV */
-// Ключ шифрования (4 слова по 32 бита)
-static const uint32_t secure_key[4] = {
-		0x0F0E0D0C, 0x0B0A0908, 0x07060504, 0x03020100
-};
+// Ключ шифрования развернут при сборке в secure_key_ctx (Core/Src/speck_keys.c,
+// генерируется Tools/speck_keygen из 0x0F0E0D0C 0x0B0A0908 0x07060504 0x03020100)
 
 // Контекст защищенного UART
 static SecUartContext secure_uart_ctx;
 
-uint8_t test_dataXS[8] = {0xE1, 0x09, 0xCA, 0x06, 0x5D, 0xE3, 0x74, 0x83};
-
-uint8_t test_dataS[16] = {0x0C, 0x78, 0x0A, 0x2B, 0xFA, 0xAC, 0x5B, 0xB9, 0xE6, 0x0E, 0xA2, 0x83, 0xED, 0xD9, 0x69, 0x13};
-
-uint8_t test_dataM[32] = {0x59, 0x67, 0xA6, 0xE8, 0x5C, 0xFF, 0x9A, 0x88, 0x56, 0xC6, 0x24, 0x4A, 0xA1, 0x9A, 0x9C, 0xF5,
-		0x4D, 0x70, 0xA6, 0x4D, 0x50, 0xE9, 0x3A, 0x17, 0xB8, 0x1C, 0x9B, 0x57, 0xFD, 0x4B, 0xFC, 0x9C};
-
-uint8_t test_dataL[64] = {0x8B, 0xC4, 0xAC, 0x73, 0x8B, 0x9F, 0x9A, 0xAF, 0xC5, 0x9A, 0xD4, 0xA3, 0x14, 0x30, 0xA7, 0x2C,
-		0x96, 0x3F, 0xFB, 0xEE, 0x61, 0xD7, 0xCA, 0x12, 0xE1, 0x06, 0x39, 0x90, 0xD3, 0xAE, 0x40, 0xF3, 0x32, 0x53, 0xE6,
-		0xA9, 0x6E, 0xAF, 0xFF, 0x71, 0xB4, 0x91, 0x6D, 0x4F, 0xA8, 0x09, 0x16, 0xB9, 0xB7, 0x8D, 0x08, 0x08, 0x4F, 0xE5,
-		0xB8, 0xF8, 0x32, 0xA8, 0x5C, 0x75, 0x1F, 0x80, 0x0A, 0x9D};
-
-uint8_t test_dataXL[128] = {0x72, 0x07, 0xFE, 0xAF, 0x5A, 0x6B, 0x35, 0xA6, 0x4B, 0xA8, 0x03, 0xBE, 0x97, 0xEA, 0x1E, 0x09,
-		0x61, 0x4C, 0xB9, 0xDA, 0x13, 0x20, 0x96, 0xD5, 0xA6, 0x07, 0xD1, 0x07, 0xC5, 0x1D, 0xD4, 0x69, 0x8B, 0x15, 0xE3,
-		0x81, 0x6C, 0x51, 0x53, 0x6C, 0x6E, 0xAF, 0xE7, 0x22, 0xCE, 0x5F, 0x63, 0xCE, 0xBA, 0x7A, 0x78, 0xA6, 0x2B, 0x8D,
-		0x55, 0xFA, 0x68, 0x7B, 0x0F, 0xD7, 0x99, 0x6C, 0xB4, 0x20, 0x67, 0xD9, 0x7A, 0xE1, 0xEE, 0x1E, 0xE2, 0xDB, 0x38,
-		0xE6, 0xAE, 0x2D, 0x8C, 0x25, 0x2F, 0x96, 0xC4, 0x7D, 0x95, 0xEC, 0xF6, 0x94, 0x26, 0x1C, 0x8C, 0xEE, 0x03, 0xBF,
-		0xF1, 0x1C, 0x8B, 0xD4, 0x81, 0x04, 0x86, 0xC6, 0xC9, 0xEB, 0x39, 0x7E, 0x59, 0x90, 0x9D, 0x81, 0x2F, 0x64, 0xEB,
-		0x5F, 0x0F, 0xE6, 0x4B, 0x0A, 0x6C, 0x87, 0xD4, 0xB9, 0x48, 0xDC, 0xCF, 0x21, 0x51, 0x18, 0xFE, 0xDD};
-
 // Буфер для данных
 static uint8_t data_buffer[DATA_BUFFER_SIZE];
 static uint8_t data_size = 0;
@@ -101,37 +82,37 @@ static void SendPeriodicMessage(void);
 /* USER CODE BEGIN 0 */
 
 /**
- * @brief Обработчик прерывания IDLE для UART
+ * @brief Обработчик событий приема UART (IDLE, половина и конец кольца DMA)
  */
 void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size) {
-	// Вызываем обработчик IDLE из нашей библиотеки
-	SecUart_RxIdleCallback(&secure_uart_ctx, huart);
+	// Вызываем обработчик событий приема из нашей библиотеки
+	SecUart_RxEventCallback(&secure_uart_ctx, huart);
+}
+
+/**
+ * @brief Обработчик ошибок UART
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+	// Перезапускаем циклический прием, если HAL остановил его из-за ошибки
+	SecUart_ErrorCallback(&secure_uart_ctx, huart);
 }
 
 /**
  * @brief Обработчик завершения передачи по DMA
  */
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
-	// Добавляем логирование
-	char debug[64];
-	sprintf(debug, "HAL_UART_TxCpltCallback called for UART: 0x%lX\r\n", (uint32_t)huart->Instance);
-	HAL_UART_Transmit(&huart2, (uint8_t*)debug, strlen(debug), 100);
-
-	if (huart == secure_uart_ctx.huart_tx) {
-		// Устанавливаем флаг завершения передачи
-		secure_uart_ctx.tx_complete = true;
-		HAL_UART_Transmit(&huart2, (uint8_t*)"TX Complete flag set to true\r\n", 30, 100);
-	}
+	// Освобождаем слот очереди и запускаем следующий фрейм без задержки
+	SecUart_TxCpltCallback(&secure_uart_ctx, huart);
 }
 
 /**
  * @brief Обработка защищенного UART
  */
 static void ProcessSecureUart(void) {
-    // Проверяем, есть ли принятые данные
-    if (secure_uart_ctx.rx_complete) {
-        // Буфер для расшифрованных данных
-        uint8_t rx_data[DATA_BUFFER_SIZE];
+    // Разбираем все фреймы, накопившиеся в кольце приема
+    while (secure_uart_ctx.rx_complete) {
+        // Буфер для расшифрованных данных (+1 под завершающий нуль)
+        uint8_t rx_data[SECUART_MAX_DATA_SIZE + 1];
         uint8_t rx_size;
         SecUartMsgType rx_type;
 
@@ -145,6 +126,16 @@ static void ProcessSecureUart(void) {
                     "Received data [type=%u, size=%u]: ", rx_type, rx_size);
             SecUart_Log(&secure_uart_ctx, log_buffer);
 
+#if SECUART_BULK
+            // Длинное сообщение остается в буфере сборки - выводим только размер
+            uint16_t bulk_size;
+            if (SecUart_BulkData(&secure_uart_ctx, &bulk_size) != NULL) {
+                snprintf(log_buffer, sizeof(log_buffer), "bulk, %u bytes\r\n", bulk_size);
+                SecUart_Log(&secure_uart_ctx, log_buffer);
+                continue;
+            }
+#endif
+
             // Обрабатываем только сообщения типа DATA
             if (rx_type == SECUART_MSG_DATA) {
                 // Определяем максимальное количество байт для вывода
@@ -174,6 +165,10 @@ static void ProcessSecureUart(void) {
                 SecUart_Log(&secure_uart_ctx, "\r\n");
             }
         }
+        else if (err == SECUART_ERR_TIMEOUT) {
+            // Полного фрейма еще нет - остаток придет со следующими событиями DMA
+            break;
+        }
         else {
             char log_buffer[64];
             snprintf(log_buffer, sizeof(log_buffer),
@@ -203,12 +198,6 @@ static void SendPeriodicMessage(void) {
 
 	// Проверяем, прошло ли достаточно времени с последней отправки
 	if (current_time - last_tx_time >= TX_PERIOD_MS) {
-		// Если предыдущая передача не завершена, пробуем принудительно сбросить флаг
-		if (!secure_uart_ctx.tx_complete) {
-			SecUart_Log(&secure_uart_ctx, "WARNING: Forcing tx_complete to true\r\n");
-			secure_uart_ctx.tx_complete = true;
-		}
-
 		// Формируем тестовое сообщение
 		uint8_t msg_data[TEST_SIZE] = {0};
 
@@ -221,7 +210,8 @@ static void SendPeriodicMessage(void) {
 		SecUartError err = SecUart_Send(&secure_uart_ctx, msg_data, msg_size, SECUART_MSG_DATA);
 
 
-		if (err == SECUART_OK) {
+		// SECUART_ERR_TX_START: фрейм уже в очереди, повторять не нужно
+		if (err == SECUART_OK || err == SECUART_ERR_TX_START) {
 			// Обновляем время последней отправки
 			last_tx_time = current_time;
 			SecUart_Log(&secure_uart_ctx, "INFO: Message sent successfully\r\n");
@@ -275,8 +265,18 @@ int main(void)
     DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
     DWT->CYCCNT = 0;
 
+#if MAC_BENCH
+	// Сравнение алгоритмов MAC до старта протокола, пока монитор не занят
+	MacBench_Run(&huart2, &secure_key_ctx);
+	MacBench_Replay(&huart2);
+#if SECUART_LZ
+	MacBench_Compress(&huart2);
+#endif
+#endif
+
 	// Инициализация защищенного UART
-	SecUartError err = SecUart_Init(&secure_uart_ctx, &huart1, &huart6, &huart2, secure_key);
+	SecUartError err = SecUart_InitPrebuilt(&secure_uart_ctx, &huart1, &huart6, &huart2,
+			&secure_key_ctx, SECUART_SUITE_DEFAULT, SECUART_NODE_ROLE);
 
 	if (err != SECUART_OK) {
 		// Ошибка инициализации
@@ -310,6 +310,12 @@ int main(void)
 
 		SendPeriodicMessage();
 
+		// Агрегат SecUart_Post, который ждет дольше agg_delay_ms, уходит сейчас
+		SecUart_Poll(&secure_uart_ctx);
+
+		// В простое готовим гамму CTR для следующих фреймов
+		SecUart_PrecomputeKeystream(&secure_uart_ctx, SECUART_KS_BLOCKS);
+
 		/* USER CODE END WHILE */
 
 		/* USER CODE BEGIN 3 */
@@ -9,26 +9,145 @@
 #include <stdio.h>
 
 // Статические вспомогательные функции
-static void SecUart_EncryptBlock(const SpeckContext *ctx, uint8_t *data, uint8_t size);
-static void SecUart_DecryptBlock(const SpeckContext *ctx, uint8_t *data, uint8_t size);
-static void SecUart_CalculateMAC(const SpeckContext *ctx, const uint8_t *data, uint8_t size, uint8_t *mac);
-static bool SecUart_VerifyMAC(const SpeckContext *ctx, const uint8_t *data, uint8_t size, const uint8_t *mac);
-static void SecUart_PrepareFrame(SecUartContext *ctx, const uint8_t *data, uint8_t size, SecUartMsgType msg_type);
-
-extern UART_HandleTypeDef huart2;
+static void SecUart_KeystreamBlock(const SpeckContext *ctx, uint32_t counter, uint32_t index, uint8_t *out);
+static void SecUart_CtrXor(const SpeckContext *ctx, const SecUartKeystream *pool, uint32_t dir, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size);
+static uint16_t SecUart_FillKeystream(const SpeckContext *ctx, SecUartKeystream *pool, uint32_t dir, uint32_t base, uint16_t max_blocks);
+static void SecUart_PayloadCrypt(const SecUartContext *ctx, bool tx, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size);
+static void SecUart_MacInit(const SecUartContext *ctx, SecUartMac *mac_ctx);
+#if SECUART_SUITE_SIPHASH || SECUART_SUITE_HALFSIPHASH
+static void SecUart_DeriveMacKey(SecUartContext *ctx);
+#endif
+static void SecUart_MacUpdate(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *data, uint16_t len);
+static void SecUart_MacFinal(const SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *mac);
+static bool SecUart_VerifyMAC(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *mac);
+static uint8_t SecUart_PrepareFrame(SecUartContext *ctx, uint8_t *frame, const uint8_t *data, uint8_t size, SecUartMsgType msg_type);
+static uint8_t SecUart_BuildHeader(SecUartContext *ctx, uint8_t *frame, uint8_t *stage, const uint8_t *data, uint8_t size, SecUartMsgType msg_type);
+static bool SecUart_SealBlocks(SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *frame, const uint8_t *src, uint16_t from, uint16_t to, uint16_t fence_len);
+static uint16_t SecUart_TxReadPos(SecUartContext *ctx, uint16_t length);
+static void SecUart_AbortTx(SecUartContext *ctx);
+#if SECUART_TX_CUT_THROUGH
+static HAL_StatusTypeDef SecUart_SendCutThrough(SecUartContext *ctx, SecUartTxSlot *slot, const uint8_t *data, uint8_t size, SecUartMsgType msg_type, uint32_t *first_byte_cycles, uint32_t *total_cycles);
+#endif
+static void SecUart_RxPump(SecUartContext *ctx);
+static void SecUart_ReleaseRxSlot(SecUartContext *ctx);
+static void SecUart_ResumeRx(SecUartContext *ctx);
+static void SecUart_TxSlotDone(SecUartContext *ctx);
+#if SECUART_BULK
+static SecUartBulkBuffer *SecUart_BulkAlloc(SecUartContext *ctx);
+static void SecUart_BulkRelease(SecUartContext *ctx);
+#endif
+static bool SecUart_ParseRxStream(SecUartContext *ctx, uint8_t *frame, uint32_t head);
+static void SecUart_RxCryptBlocks(SecUartContext *ctx, uint16_t limit);
+static void SecUart_FinishRxFrame(SecUartContext *ctx, SecUartRxSlot *slot);
+static void SecUart_ResyncRx(SecUartContext *ctx);
+static bool SecUart_IsSof(uint8_t byte);
+static uint32_t SecUart_FrameCounter(const uint8_t *frame);
+static bool SecUart_ExpandCounter(const SecUartContext *ctx, const uint8_t *frame, uint32_t *counter);
+static void SecUart_MacHeader(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *frame, uint32_t counter, uint32_t dir);
+static void SecUart_XorBlock(uint8_t *data, const uint8_t *gamma, uint16_t n);
+static HAL_StatusTypeDef SecUart_StartNextTx(SecUartContext *ctx);
+static SecUartError SecUart_SendFrame(SecUartContext *ctx, const uint8_t *data, uint8_t size, SecUartMsgType msg_type);
+static SecUartError SecUart_ReserveCounter(SecUartContext *ctx);
+#if SECUART_CNT_PERSIST
+static void SecUart_CntService(SecUartContext *ctx);
+#endif
+static SecUartError SecUart_NextAggregated(SecUartContext *ctx, const uint8_t *agg, uint8_t agg_size, uint8_t *data, uint8_t *size, SecUartMsgType *msg_type, bool *last);
+#if SECUART_ARQ
+static SecUartError SecUart_EnqueueFrame(SecUartContext *ctx, const uint8_t *frame, uint16_t length);
+static SecUartError SecUart_ArqAccept(SecUartContext *ctx, uint8_t seq, uint32_t counter, bool syn);
+static void SecUart_ArqSendAck(SecUartContext *ctx);
+static void SecUart_ArqHandleAck(SecUartContext *ctx, SecUartMsgType msg_type, const uint8_t *data, uint8_t size);
+static void SecUart_ArqRetransmit(SecUartContext *ctx, uint8_t seq);
+#endif
+
+// Раскладка заголовка определяется по SOF: v2 выравнивает данные на 8
+// байт от начала слота, v1 - исходные 6 байт,
+// короткий заголовок - как v1, но только с младшими байтами CNT.
+// Длинный фрейм v2 узнается по FLAGS, заголовок у него длиннее на ~LEN
+#define SECUART_FRAME_IS_V2(frame)     ((frame)[0] == SECUART_START_BYTE_V2)
+#define SECUART_FRAME_IS_SHORT(frame)  ((frame)[0] == SECUART_START_BYTE_S8 || (frame)[0] == SECUART_START_BYTE_S16)
+#define SECUART_FRAME_HDR(frame)       (SECUART_FRAME_IS_V2(frame) ? \
+                                        (SECUART_FRAME_IS_EXT(frame) ? SECUART_HEADER_SIZE_EXT : SECUART_HEADER_SIZE_V2) : \
+                                        (frame)[0] == SECUART_START_BYTE_S8 ? SECUART_HEADER_SIZE_S8 : \
+                                        (frame)[0] == SECUART_START_BYTE_S16 ? SECUART_HEADER_SIZE_S16 : SECUART_HEADER_SIZE)
+#define SECUART_FRAME_LEN(frame)       (SECUART_FRAME_IS_V2(frame) ? (frame)[3] : (frame)[SECUART_FRAME_HDR(frame) - 1])
+
+// Надежный фрейм ARQ (только v2): номер в байте RSV
+#if SECUART_ARQ
+#define SECUART_FRAME_IS_ARQ(frame)    (SECUART_FRAME_IS_V2(frame) && ((frame)[1] & SECUART_FLAG_ARQ))
+#define SECUART_FRAME_IS_SYN(frame)    (SECUART_FRAME_IS_V2(frame) && ((frame)[1] & SECUART_FLAG_SYN))
+#else
+#define SECUART_FRAME_IS_ARQ(frame)    false
+#define SECUART_FRAME_IS_SYN(frame)    false
+#endif
+
+// Длинный фрейм (только v2): RSV - старший байт LEN, за CNT - ~LEN и два нуля
+#if SECUART_BULK
+#define SECUART_FRAME_IS_EXT(frame)    (SECUART_FRAME_IS_V2(frame) && ((frame)[1] & SECUART_FLAG_EXT))
+#define SECUART_FRAME_EXT_LEN(frame)   ((uint16_t)(((frame)[2] << 8) | (frame)[3]))
+#else
+#define SECUART_FRAME_IS_EXT(frame)    false
+#define SECUART_FRAME_EXT_LEN(frame)   0
+#endif
+
+// Фрейм принят в очередь передачи (DMA мог не запуститься - его запустит SecUart_Poll)
+#define SECUART_TX_QUEUED(err)         ((err) == SECUART_OK || (err) == SECUART_ERR_TX_START)
+
+// Сжатые данные (только v2)
+#if SECUART_LZ
+#define SECUART_FRAME_IS_LZ(frame)     (SECUART_FRAME_IS_V2(frame) && ((frame)[1] & SECUART_FLAG_LZ))
+#else
+#define SECUART_FRAME_IS_LZ(frame)     false
+#endif
+
+// Флаги v2, которые понимает эта сборка
+#define SECUART_V2_FLAGS               ((SECUART_ARQ ? SECUART_FLAG_ARQ | SECUART_FLAG_SYN : 0) | (SECUART_BULK ? SECUART_FLAG_EXT : 0) | \
+                                        (SECUART_LZ ? SECUART_FLAG_LZ : 0))
+
+// Набор алгоритмов контекста; при единственном наборе - константная таблица,
+// и компилятор подставляет прямые вызовы вместо косвенных
+#if SECUART_SUITE_COUNT > 1
+#define SECUART_SUITE(ctx)             ((ctx)->suite)
+#else
+#define SECUART_SUITE(ctx)             SECUART_SUITE_DEFAULT
+#endif
 
 /**
- * @brief Инициализация контекста защищенного UART
+ * @brief Инициализация контекста с готовыми раундовыми ключами
  */
-SecUartError SecUart_Init(SecUartContext *ctx,
+SecUartError SecUart_InitPrebuilt(SecUartContext *ctx,
 		UART_HandleTypeDef *huart_tx,
 		UART_HandleTypeDef *huart_rx,
 		UART_HandleTypeDef *huart_monitor,
-		const uint32_t *key) {
+		const SpeckContext *cipher,
+		const SecUartSuite *suite,
+		SecUartRole role) {
+
+	if (ctx == NULL || huart_tx == NULL || huart_rx == NULL || suite == NULL ||
+			(role != SECUART_ROLE_A && role != SECUART_ROLE_B)) {
+		return SECUART_ERR_INVALID_SOF;
+	}
+
+	// Ключ Speck нужен всем наборам, кроме CRC-only
+	if (cipher == NULL && suite->encrypt != NULL) {
+		return SECUART_ERR_INVALID_SOF;
+	}
 
-	if (ctx == NULL || huart_tx == NULL || huart_rx == NULL || key == NULL) {
+#if SECUART_SUITE_COUNT > 1
+	ctx->suite = suite;
+#else
+	// Собран один набор - другой выбрать нельзя
+	if (suite != SECUART_SUITE(ctx)) {
 		return SECUART_ERR_INVALID_SOF;
 	}
+#endif
+
+#if SECUART_SUITE_CRC
+	// Таблицы CRC16 строятся при первом выборе набора
+	if (suite == &SecUart_SuiteCrc) {
+		CrcEngine_Init();
+	}
+#endif
 
 	// Инициализация интерфейсов UART
 	ctx->huart_tx = huart_tx;
@@ -37,24 +156,129 @@ SecUartError SecUart_Init(SecUartContext *ctx,
 
 	// Инициализация счетчиков и флагов
 	ctx->tx_counter = 0;
+	ctx->tx_cnt_sync = 0;
 	ctx->rx_counter = 0;
+	ctx->rx_counter_valid = false;
+	ctx->rx_cnt_ref = 0;
+	ctx->rx_cnt_ref_valid = false;
+	memset(ctx->rx_replay, 0, sizeof(ctx->rx_replay));
 	ctx->rx_complete = false;
 	ctx->tx_complete = true;
+	ctx->tx_q_head = 0;
+	ctx->tx_q_tail = 0;
 	ctx->packets_sent = 0;
 	ctx->packets_received = 0;
 	ctx->errors_detected = 0;
+	ctx->tx_late = 0;
 
-	// Инициализация контекста шифрования
-	speck_init(&ctx->cipher_ctx, key);
+#if SECUART_CNT_PERSIST
+	// CNT продолжается с границы, сохраненной до сброса: все CNT прошлых
+	// запусков не больше нее, и их гамма больше не выпадет
+	if (!CntStore_Load(&ctx->tx_counter)) {
+		return SECUART_ERR_STORAGE;
+	}
+	ctx->tx_cnt_limit = ctx->tx_counter;
+#endif
+
+	// Раундовые ключи используются на месте, без копирования в RAM
+	ctx->cipher_ctx = cipher;
+#if SECUART_SUITE_SIPHASH || SECUART_SUITE_HALFSIPHASH
+	if (cipher != NULL) {
+		SecUart_DeriveMacKey(ctx);
+	}
+#endif
+
+	ctx->rx_overruns = 0;
+	ctx->rx_resyncs = 0;
+	ctx->rx_bulk_dropped = 0;
+	ctx->rx_role_mismatch = 0;
+	ctx->rx_role_ok = false;
+	ctx->rx_q_head = 0;
+	ctx->rx_q_tail = 0;
+	ctx->rx_stalled = false;
+	ctx->rx_error = SECUART_OK;
+	ctx->rx_agg_pos = 0;
+#if SECUART_LZ
+	// Сжатие включает приложение, зная свои данные: длина фрейма выдает их содержимое
+	ctx->tx_compress = false;
+	ctx->rx_lz_len = 0;
+#endif
+#if SECUART_BULK
+	for (uint8_t i = 0; i < SECUART_BULK_POOL_LEN; i++) {
+		ctx->rx_bulk_pool[i].busy = false;
+	}
+	for (uint8_t i = 0; i < SECUART_TX_QUEUE_LEN; i++) {
+		ctx->tx_queue[i].ext = NULL;
+	}
+	ctx->rx_bulk_cur = NULL;
+	ctx->rx_bulk_held = NULL;
+	ctx->rx_bulk_data = NULL;
+	ctx->rx_bulk_size = 0;
+	ctx->tx_bulk_busy = false;
+#endif
+#if SECUART_AGGREGATION
+	ctx->agg_len = 0;
+	ctx->agg_count = 0;
+	ctx->agg_flush_pending = false;
+	ctx->agg_delay_ms = SECUART_AGG_DELAY_MS;
+#endif
+#if SECUART_ARQ
+	ctx->arq_tx_base = 0;
+	ctx->arq_tx_next = 0;
+	ctx->arq_tx_mark = false;
+	ctx->arq_tx_syn = true;
+	ctx->arq_window = SECUART_ARQ_WINDOW;
+	ctx->arq_timeout_ms = SECUART_ARQ_TIMEOUT_MS;
+	ctx->arq_rx_next = 0;
+	ctx->arq_rx_map = 0;
+	ctx->arq_rx_base_cnt = 0;
+	ctx->arq_rx_top_cnt = 0;
+	ctx->arq_rx_synced = false;
+	ctx->arq_ack_pending = false;
+#endif
+	ctx->arq_retransmits = 0;
 
 	// Очистка буферов
-	memset(ctx->tx_buffer, 0, SECUART_BUFFER_SIZE);
-	memset(ctx->rx_buffer, 0, SECUART_BUFFER_SIZE);
+	memset(ctx->rx_queue, 0, sizeof(ctx->rx_queue));
+	memset(ctx->rx_ring, 0, SECUART_RX_RING_SIZE);
+	memset(ctx->tx_ks, 0, sizeof(ctx->tx_ks));
+	memset(ctx->rx_ks, 0, sizeof(ctx->rx_ks));
+
+	// Свой бит направления в гамме передачи, бит узла на другом конце - в гамме приема
+	ctx->tx_dir = (role == SECUART_ROLE_B) ? SECUART_CTR_DIR_BIT : 0;
+	ctx->rx_dir = ctx->tx_dir ^ SECUART_CTR_DIR_BIT;
+
+	char log_buffer[48];
+	snprintf(log_buffer, sizeof(log_buffer), "Cipher suite: %s\r\n", suite->name);
+	SecUart_Log(ctx, log_buffer);
 
 	// Запуск приема данных по DMA
 	return SecUart_StartReceive(ctx);
 }
 
+#if SECUART_RUNTIME_KEY
+/**
+ * @brief Инициализация контекста защищенного UART
+ */
+SecUartError SecUart_Init(SecUartContext *ctx,
+		UART_HandleTypeDef *huart_tx,
+		UART_HandleTypeDef *huart_rx,
+		UART_HandleTypeDef *huart_monitor,
+		const uint32_t *key,
+		const SecUartSuite *suite,
+		SecUartRole role) {
+
+	if (ctx == NULL || key == NULL) {
+		return SECUART_ERR_INVALID_SOF;
+	}
+
+	// Разворачиваем ключ в RAM контекста
+	speck_init(&ctx->cipher_store, key);
+
+	return SecUart_InitPrebuilt(ctx, huart_tx, huart_rx, huart_monitor, &ctx->cipher_store, suite, role);
+}
+#endif
+
 /**
  * @brief Запуск приема по DMA
  */
@@ -66,29 +290,26 @@ SecUartError SecUart_StartReceive(SecUartContext *ctx) {
 	// Сначала останавливаем любой текущий прием
 	HAL_UART_AbortReceive(ctx->huart_rx);
 
-	// Сброс флага завершения приема
-	ctx->rx_complete = false;
-
-	// Очистка буфера приема
-	memset(ctx->rx_buffer, 0, SECUART_BUFFER_SIZE);
-
-	// Запуск приема данных по DMA до прерывания IDLE
-	if (HAL_UART_Receive_DMA(ctx->huart_rx, ctx->rx_buffer, SECUART_BUFFER_SIZE) != HAL_OK) {
+	// Сброс состояния кольцевого буфера (очередь готовых фреймов сохраняется)
+	ctx->rx_head = 0;
+	ctx->rx_tail = 0;
+	ctx->rx_dma_pos = 0;
+	ctx->rx_state = SECUART_RX_HUNT_SOF;
+	ctx->rx_frame_pos = 0;
+	ctx->rx_frame_len = 0;
+
+	// Запуск непрерывного приема по циклическому DMA.
+	// HAL вызывает RxEvent по IDLE, половине и концу кольца и не останавливает поток.
+	if (HAL_UARTEx_ReceiveToIdle_DMA(ctx->huart_rx, ctx->rx_ring, SECUART_RX_RING_SIZE) != HAL_OK) {
 		return SECUART_ERR_TIMEOUT;
 	}
 
-	// Включение прерывания IDLE
-	__HAL_UART_ENABLE_IT(ctx->huart_rx, UART_IT_IDLE);
-
 	// Отладочное сообщение
-	SecUart_Log(ctx, "DMA receive restarted\r\n");
+	SecUart_Log(ctx, "DMA ring receive started\r\n");
 
 	return SECUART_OK;
 }
 
-/**
- * @brief Отправка данных через защищенный UART
- */
 /**
  * @brief Отправка данных через защищенный UART
  */
@@ -97,66 +318,177 @@ SecUartError SecUart_Send(SecUartContext *ctx,
 		uint8_t size,
 		SecUartMsgType msg_type) {
 
-	if (ctx == NULL || data == NULL || size == 0 || size > SECUART_MAX_DATA_SIZE) {
+#if SECUART_AGGREGATION
+	// Накопленные SecUart_Post сообщения должны уйти раньше этого
+	if (ctx != NULL && ctx->agg_count > 0) {
+		SecUartError err = SecUart_Flush(ctx);
+		if (!SECUART_TX_QUEUED(err)) {
+			return err;
+		}
+	}
+#endif
+
+	return SecUart_SendFrame(ctx, data, size, msg_type);
+}
+
+#if SECUART_BULK
+/**
+ * @brief Отправка длинного сообщения одним фреймом
+ */
+SecUartError SecUart_SendBulk(SecUartContext *ctx,
+		const uint8_t *data,
+		uint16_t size,
+		SecUartMsgType msg_type) {
+
+	if (ctx == NULL || data == NULL || size == 0 || size > SECUART_BULK_MAX_SIZE) {
 		return SECUART_ERR_INVALID_SOF;
 	}
 
-	// Проверяем, завершена ли предыдущая передача
-	if (!ctx->tx_complete) {
-		// Добавляем лог для отладки
-		SecUart_Log(ctx, "TX busy, tx_complete is false\r\n");
-
-		// Проверяем статус UART и DMA
-		uint32_t uart_status = ctx->huart_tx->gState;
-		char status_buf[64];
-		snprintf(status_buf, sizeof(status_buf),
-				"UART State: 0x%lX\r\n", uart_status);
-		SecUart_Log(ctx, status_buf);
-
-		// Если UART находится в состоянии ошибки или неизвестном состоянии, сбрасываем его
-		if (uart_status != HAL_UART_STATE_READY && uart_status != HAL_UART_STATE_BUSY_TX) {
-			SecUart_Log(ctx, "Resetting UART TX state\r\n");
-			HAL_UART_AbortTransmit(ctx->huart_tx);
-			ctx->tx_complete = true;
-		} else {
-			return SECUART_ERR_TIMEOUT;
+	// Помещается в обычный фрейм
+	if (size <= SECUART_MAX_DATA_SIZE) {
+		return SecUart_Send(ctx, data, (uint8_t)size, msg_type);
+	}
+
+#if SECUART_AGGREGATION
+	// Накопленные SecUart_Post сообщения должны уйти раньше этого
+	if (ctx->agg_count > 0) {
+		SecUartError err = SecUart_Flush(ctx);
+		if (!SECUART_TX_QUEUED(err)) {
+			return err;
 		}
 	}
+#endif
+
+	if (ctx->tx_bulk_busy || ctx->tx_q_head - ctx->tx_q_tail >= SECUART_TX_QUEUE_LEN) {
+		SecUart_Log(ctx, "TX bulk busy\r\n");
+		return SECUART_ERR_BUFFER_OVERFLOW;
+	}
 
-	// Подготовка фрейма для отправки
-	uint32_t t0_prep = DWT->CYCCNT;
-	SecUart_PrepareFrame(ctx, data, size, msg_type);
-	uint32_t t1_prep = DWT->CYCCNT - t0_prep;
+	SecUartError err = SecUart_ReserveCounter(ctx);
+	if (err != SECUART_OK) {
+		return err;
+	}
 
-	// Общий размер фрейма: заголовок + размер данных + MAC
-	uint16_t frame_size = SECUART_HEADER_SIZE + size + SECUART_MAC_SIZE;
+	uint8_t *frame = ctx->tx_bulk;
+	const uint8_t hdr = SECUART_HEADER_SIZE_EXT;
+	SecUartMac mac_ctx;
+
+	// Заголовок v2: LEN в RSV (старший байт) и LEN (младший), за CNT - ~LEN
+	ctx->tx_counter++;
+	ctx->tx_cnt_sync = ctx->tx_counter;
+	uint32_t cnt_be = __REV(ctx->tx_counter);
+	frame[0] = SECUART_START_BYTE_V2;             // SOF
+	frame[1] = SECUART_FLAG_EXT;                  // FLAGS
+	frame[2] = (size >> 8) & 0xFF;                // LEN (старший байт)
+	frame[3] = size & 0xFF;                       // LEN (младший байт)
+	memcpy(frame + 4, &cnt_be, sizeof(cnt_be));   // CNT (big-endian)
+	frame[8] = ~frame[2];                         // ~LEN
+	frame[9] = ~frame[3];
+	frame[10] = 0;                                // Выравнивание данных на слово
+	frame[11] = 0;
+
+	frame[hdr] = msg_type;
+	memcpy(frame + hdr + 1, data, size - 1);
+
+	// Один MAC на весь фрейм
+	SecUart_MacInit(ctx, &mac_ctx);
+	SecUart_MacHeader(ctx, &mac_ctx, frame, ctx->tx_counter, ctx->tx_dir);
+	SecUart_SealBlocks(ctx, &mac_ctx, frame, NULL, 0, size, 0);
+	SecUart_MacFinal(ctx, &mac_ctx, frame + hdr + size);
+
+	// Слот очереди только ссылается на tx_bulk - фрейм не копируется
+	SecUartTxSlot *slot = &ctx->tx_queue[ctx->tx_q_head & SECUART_TX_QUEUE_MASK];
+	slot->ext = frame;
+	slot->length = hdr + size + SECUART_SUITE(ctx)->tag_size;
+	ctx->tx_bulk_busy = true;
+
+	__DMB();
+	ctx->tx_q_head++;
+	HAL_StatusTypeDef hal_status = SecUart_StartNextTx(ctx);
 
-	// Сброс флага завершения передачи
-	ctx->tx_complete = false;
+	ctx->packets_sent++;
 
-	// Отправка данных по DMA
-	uint32_t t0_send = DWT->CYCCNT;
-	HAL_StatusTypeDef hal_status = HAL_UART_Transmit_DMA(ctx->huart_tx, ctx->tx_buffer, frame_size);
-	uint32_t t1_send = DWT->CYCCNT - t0_send;
+	return (hal_status == HAL_OK) ? SECUART_OK : SECUART_ERR_TX_START;
+}
+#endif
+
+/**
+ * @brief Постановка одного фрейма в очередь передачи
+ */
+static SecUartError SecUart_SendFrame(SecUartContext *ctx, const uint8_t *data, uint8_t size, SecUartMsgType msg_type) {
+	if (ctx == NULL || data == NULL || size == 0) {
+		return SECUART_ERR_INVALID_SOF;
+	}
 
-    char cycles_msg1[64];
-    char cycles_msg2[64];
+	// Проверяем, есть ли свободный слот в очереди передачи
+	if (ctx->tx_q_head - ctx->tx_q_tail >= SECUART_TX_QUEUE_LEN) {
+		SecUart_Log(ctx, "TX queue full\r\n");
+		return SECUART_ERR_BUFFER_OVERFLOW;
+	}
 
-    sprintf(cycles_msg1, "Cycles used (PREPARING): %lu\r\n", t1_prep);
-    sprintf(cycles_msg2, "Cycles used (SENDING): %lu\r\n", t1_send);
+	SecUartError cnt_error = SecUart_ReserveCounter(ctx);
+	if (cnt_error != SECUART_OK) {
+		return cnt_error;
+	}
 
-    HAL_UART_Transmit(&huart2, (uint8_t*)cycles_msg1, strlen(cycles_msg1), 100);
-    HAL_UART_Transmit(&huart2, (uint8_t*)cycles_msg2, strlen(cycles_msg2), 100);
+	// Слот tx_q_head принадлежит CPU: DMA работает только со слотами
+	// [tx_q_tail, tx_q_head), поэтому фрейм N+1 шифруется прямо в свой слот,
+	// пока фрейм N еще уходит по DMA2_Stream7
+	SecUartTxSlot *slot = &ctx->tx_queue[ctx->tx_q_head & SECUART_TX_QUEUE_MASK];
+
+	HAL_StatusTypeDef hal_status;
+	uint32_t t1_prep;
+	uint32_t t1_send;
+
+#if SECUART_TX_CUT_THROUGH
+	if (ctx->tx_complete && ctx->tx_q_head == ctx->tx_q_tail) {
+		// Линия свободна: заголовок и первый блок уходят сразу, остальные
+		// блоки шифруются впереди указателя чтения DMA
+		hal_status = SecUart_SendCutThrough(ctx, slot, data, size, msg_type,
+				&t1_send, &t1_prep);
+		size = SECUART_FRAME_LEN(slot->frame);
+	} else
+#endif
+	{
+		// Подготовка фрейма для отправки
+		uint32_t t0_prep = DWT->CYCCNT;
+		size = SecUart_PrepareFrame(ctx, slot->frame, data, size, msg_type);
+		t1_prep = DWT->CYCCNT - t0_prep;
+
+		// Общий размер фрейма: заголовок + размер данных (после сжатия) + MAC
+		slot->length = SECUART_FRAME_HDR(slot->frame) + size + SECUART_SUITE(ctx)->tag_size;
+
+		// Передаем слот DMA: после сдвига tx_q_head его вернет только TxCplt
+		__DMB();
+		ctx->tx_q_head++;
+
+		// Если линия свободна - запускаем DMA, иначе фрейм уйдет из TxCplt
+		uint32_t t0_send = DWT->CYCCNT;
+		hal_status = SecUart_StartNextTx(ctx);
+		t1_send = DWT->CYCCNT - t0_send;
+	}
 
+#if SECUART_CYCLE_LOG
+	// Блокирующий вывод в монитор - только для замеров
+	char cycles_msg[64];
+	snprintf(cycles_msg, sizeof(cycles_msg), "Cycles used (PREPARING): %lu\r\n", t1_prep);
+	SecUart_Log(ctx, cycles_msg);
+	snprintf(cycles_msg, sizeof(cycles_msg), "Cycles used (SENDING): %lu\r\n", t1_send);
+	SecUart_Log(ctx, cycles_msg);
+#else
+	(void)t1_prep;
+	(void)t1_send;
+#endif
+
+	SecUartError result = SECUART_OK;
 	if (hal_status != HAL_OK) {
-		// Выводим код ошибки HAL для диагностики
+		// Фрейм (и CNT) уже в очереди: его запустит следующий вызов или
+		// SecUart_Poll, вызывающему повторять отправку не нужно
 		char err_buf[64];
 		snprintf(err_buf, sizeof(err_buf),
 				"HAL TX Error: %d\r\n", hal_status);
 		SecUart_Log(ctx, err_buf);
-
-		ctx->tx_complete = true;
-		return SECUART_ERR_TIMEOUT;
+		result = SECUART_ERR_TX_START;
 	}
 
 	// Увеличиваем счетчик отправленных пакетов
@@ -169,363 +501,1877 @@ SecUartError SecUart_Send(SecUartContext *ctx,
 			ctx->tx_counter, size, msg_type);
 	SecUart_Log(ctx, log_buffer);
 
+	return result;
+}
+
+/**
+ * @brief Граница CNT во flash перед следующим фреймом
+ * @return SECUART_ERR_STORAGE - следующий CNT не защищен границей
+ */
+static SecUartError SecUart_ReserveCounter(SecUartContext *ctx) {
+#if SECUART_CNT_PERSIST
+	// Следующий CNT за сохраненной границей - сначала сдвигаем границу.
+	// Последний CNT не используется: CNT_STORE_EMPTY во flash не записать
+	if (ctx->tx_counter == ctx->tx_cnt_limit) {
+		if (ctx->tx_cnt_limit >= CNT_STORE_EMPTY - SECUART_CNT_RESERVE ||
+				!CntStore_Save(ctx->tx_cnt_limit + SECUART_CNT_RESERVE)) {
+			SecUart_Log(ctx, "ERR: TX counter not persisted\r\n");
+			return SECUART_ERR_STORAGE;
+		}
+		ctx->tx_cnt_limit += SECUART_CNT_RESERVE;
+	}
+#else
+	(void)ctx;
+#endif
+
 	return SECUART_OK;
 }
 
+#if SECUART_CNT_PERSIST
 /**
- * @brief Подготовка фрейма для отправки
+ * @brief Стирание старого сектора журнала CNT (основной цикл)
+ * @note Пока сектор стирается, выборка из flash стоит и прерывания приема не
+ *       обслуживаются, а DMA пишет кольцо дальше. Если за это время линия
+ *       могла дать полкольца, события HT/TC слились и позиция DMA
+ *       неоднозначна - прием начинается заново, как при переполнении
  */
-static void SecUart_PrepareFrame(SecUartContext *ctx, const uint8_t *data, uint8_t size, SecUartMsgType msg_type) {
-	// Очистка буфера передачи
-	memset(ctx->tx_buffer, 0, SECUART_BUFFER_SIZE);
+static void SecUart_CntService(SecUartContext *ctx) {
+	if (!CntStore_Pending()) {
+		return;
+	}
 
-	// Заполнение заголовка
-	ctx->tx_buffer[0] = SECUART_START_BYTE;                  // SOF
-	ctx->tx_counter++;                                       // Увеличиваем счетчик
-	ctx->tx_buffer[1] = (ctx->tx_counter >> 24) & 0xFF;      // CNT (MSB)
-	ctx->tx_buffer[2] = (ctx->tx_counter >> 16) & 0xFF;
-	ctx->tx_buffer[3] = (ctx->tx_counter >> 8) & 0xFF;
-	ctx->tx_buffer[4] = ctx->tx_counter & 0xFF;              // CNT (LSB)
-	ctx->tx_buffer[5] = size;                                // LEN
-
-	// Копирование данных с учетом типа сообщения
-	ctx->tx_buffer[SECUART_HEADER_SIZE] = msg_type;          // Тип сообщения
-
-	// Убедимся, что мы не выходим за границы размера, особенно для ACK
-	if (size > 1) {
-        uint8_t data_size = size - 1;
-        if (data_size > SECUART_MAX_DATA_SIZE - 1) {
-            data_size = SECUART_MAX_DATA_SIZE - 1;
-        }
+	uint32_t t0 = DWT->CYCCNT;
+	if (!CntStore_Service()) {
+		SecUart_Log(ctx, "ERR: TX counter log not erased\r\n");
+	}
+	uint32_t cycles = DWT->CYCCNT - t0;
 
-		memcpy(ctx->tx_buffer + SECUART_HEADER_SIZE + 1, data, size - 1);
+	// Байт на линии за время стирания: 10 бит на байт
+	uint32_t max_bytes = (uint32_t)((uint64_t)cycles * (ctx->huart_rx->Init.BaudRate / 10) / SystemCoreClock);
+	if (max_bytes < SECUART_RX_RING_SIZE / 2) {
+		return;
 	}
-	// Шифрование данных
-	SecUart_EncryptBlock(&ctx->cipher_ctx, ctx->tx_buffer + SECUART_HEADER_SIZE, size);
 
-	// Вычисление MAC для всего фрейма (заголовок + зашифрованные данные)
-	SecUart_CalculateMAC(&ctx->cipher_ctx, ctx->tx_buffer, SECUART_HEADER_SIZE + size,
-			ctx->tx_buffer + SECUART_HEADER_SIZE + size);
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	// rx_head идет вслед за позицией DMA, индекс в кольце - его младшие биты
+	uint16_t pos = (SECUART_RX_RING_SIZE - __HAL_DMA_GET_COUNTER(ctx->huart_rx->hdmarx)) & SECUART_RX_RING_MASK;
+	ctx->rx_head += (pos - ctx->rx_dma_pos) & SECUART_RX_RING_MASK;
+	ctx->rx_dma_pos = pos;
+	ctx->rx_overruns++;
+	ctx->errors_detected++;
+	ctx->rx_tail = ctx->rx_head;
+	ctx->rx_state = SECUART_RX_HUNT_SOF;
+	ctx->rx_error = SECUART_ERR_BUFFER_OVERFLOW;
+	ctx->rx_complete = true;
+	__set_PRIMASK(primask);
 }
+#endif
 
+#if SECUART_AGGREGATION
 /**
- * @brief Обработка принятых данных
+ * @brief Отправка сообщения с агрегацией
  */
-SecUartError SecUart_ProcessRxData(SecUartContext *ctx,
-		uint8_t *data,
-		uint8_t *size,
-		SecUartMsgType *msg_type) {
+SecUartError SecUart_Post(SecUartContext *ctx,
+		const uint8_t *data,
+		uint8_t size,
+		SecUartMsgType msg_type,
+		bool urgent) {
 
-	if (ctx == NULL || data == NULL || size == NULL || msg_type == NULL) {
+	if (ctx == NULL || data == NULL || size == 0) {
 		return SECUART_ERR_INVALID_SOF;
 	}
 
-	// Проверяем флаг завершения приема
-	if (!ctx->rx_complete) {
-		return SECUART_ERR_TIMEOUT;
+	// Подзаголовок и данные без байта типа (он уходит в подзаголовок)
+	uint16_t need = SECUART_AGG_SUBHDR_SIZE + size - 1;
+
+	// Не помещается в остаток агрегата - сначала отправляем накопленное
+	if (ctx->agg_len + need > SECUART_AGG_CAPACITY) {
+		SecUartError err = SecUart_Flush(ctx);
+		if (!SECUART_TX_QUEUED(err)) {
+			return err;
+		}
 	}
 
-	// Проверяем стартовый байт
-	if (ctx->rx_buffer[0] != SECUART_START_BYTE) {
-		ctx->errors_detected++;
-		SecUart_Log(ctx, "ERR: Invalid SOF\r\n");
-		return SECUART_ERR_INVALID_SOF;
+	// Больше целого агрегата - обычным фреймом
+	if (need > SECUART_AGG_CAPACITY) {
+		return SecUart_SendFrame(ctx, data, size, msg_type);
 	}
 
-	// Извлекаем счетчик и размер данных
-	uint32_t rx_counter = ((uint32_t)ctx->rx_buffer[1] << 24) |
-			((uint32_t)ctx->rx_buffer[2] << 16) |
-			((uint32_t)ctx->rx_buffer[3] << 8) |
-			ctx->rx_buffer[4];
-	uint8_t rx_size = ctx->rx_buffer[5];
+	if (ctx->agg_count == 0) {
+		ctx->agg_since = HAL_GetTick();
+	}
 
-	// Проверяем защиту от Replay-атак (счетчик должен быть больше предыдущего)
-	if (rx_counter <= ctx->rx_counter && ctx->rx_counter > 0) {
-		ctx->errors_detected++;
+	uint8_t *sub = ctx->agg_buf + ctx->agg_len;
+	sub[0] = size - 1;                            // LEN
+	sub[1] = msg_type;                            // TYPE
+	memcpy(sub + SECUART_AGG_SUBHDR_SIZE, data, size - 1);
+	ctx->agg_len += need;
+	ctx->agg_count++;
+
+	// Срочное сообщение или не осталось места даже на пустое вложенное.
+	// Сообщение уже принято: если очередь полна, агрегат отправит SecUart_Poll
+	if (urgent || ctx->agg_len + SECUART_AGG_SUBHDR_SIZE > SECUART_AGG_CAPACITY) {
+		SecUart_Flush(ctx);
+	}
 
-		char log_buffer[64];
-		snprintf(log_buffer, sizeof(log_buffer),
-				"ERR: Replay attack detected (%lu <= %lu)\r\n",
-				rx_counter, ctx->rx_counter);
-		SecUart_Log(ctx, log_buffer);
+	return SECUART_OK;
+}
 
-		return SECUART_ERR_REPLAY;
+/**
+ * @brief Немедленная отправка накопленного агрегата
+ */
+SecUartError SecUart_Flush(SecUartContext *ctx) {
+	SecUartError err;
+
+	if (ctx == NULL) {
+		return SECUART_ERR_INVALID_SOF;
 	}
 
-	// Проверяем размер данных
-	if (rx_size == 0 || rx_size > SECUART_MAX_DATA_SIZE) {
-		ctx->errors_detected++;
-		SecUart_Log(ctx, "ERR: Invalid data size\r\n");
-		return SECUART_ERR_BUFFER_OVERFLOW;
+	if (ctx->agg_count == 0) {
+		return SECUART_OK;
 	}
 
-	// Проверяем MAC
-	uint32_t t0_mac = DWT->CYCCNT;
-	uint8_t *rx_mac = ctx->rx_buffer + SECUART_HEADER_SIZE + rx_size;
-	bool mac_valid = SecUart_VerifyMAC(&ctx->cipher_ctx,
-			ctx->rx_buffer,
-			SECUART_HEADER_SIZE + rx_size,
-			rx_mac);
+	if (ctx->agg_count == 1) {
+		// Одно сообщение - обычным фреймом, подзаголовок не нужен
+		err = SecUart_SendFrame(ctx, ctx->agg_buf + SECUART_AGG_SUBHDR_SIZE,
+				ctx->agg_buf[0] + 1, (SecUartMsgType)ctx->agg_buf[1]);
+	} else {
+		err = SecUart_SendFrame(ctx, ctx->agg_buf, ctx->agg_len + 1, SECUART_MSG_AGGREGATE);
+	}
 
-	if (!mac_valid) {
-		ctx->errors_detected++;
-		SecUart_Log(ctx, "ERR: Invalid MAC\r\n");
-		return SECUART_ERR_INVALID_MAC;
+	if (!SECUART_TX_QUEUED(err)) {
+		ctx->agg_flush_pending = true;
+		return err;
 	}
-	uint32_t t1_mac = DWT->CYCCNT - t0_mac;
 
-	// Дешифруем данные
-	uint32_t t0_enc = DWT->CYCCNT;
-	SecUart_DecryptBlock(&ctx->cipher_ctx, ctx->rx_buffer + SECUART_HEADER_SIZE, rx_size);
-	uint32_t t1_enc = DWT->CYCCNT - t0_enc;
+	ctx->agg_len = 0;
+	ctx->agg_count = 0;
+	ctx->agg_flush_pending = false;
 
-    char cycles_msg1[64];
-    char cycles_msg2[64];
+	return err;
+}
 
-    sprintf(cycles_msg1, "Cycles used (MAC): %lu\r\n", t1_mac);
-    sprintf(cycles_msg2, "Cycles used (ENCRYPTION): %lu\r\n", t1_enc);
+#endif
 
-    HAL_UART_Transmit(&huart2, (uint8_t*)cycles_msg1, strlen(cycles_msg1), 100);
-    HAL_UART_Transmit(&huart2, (uint8_t*)cycles_msg2, strlen(cycles_msg2), 100);
+/**
+ * @brief Работа по таймеру: агрегат, подтверждения и повторы ARQ
+ */
+void SecUart_Poll(SecUartContext *ctx) {
+	if (ctx == NULL) {
+		return;
+	}
 
-	// Извлекаем тип сообщения
-	*msg_type = (SecUartMsgType)ctx->rx_buffer[SECUART_HEADER_SIZE];
+#if SECUART_CNT_PERSIST
+	SecUart_CntService(ctx);
+#endif
 
-	// Если размер данных равен 0 или 1, то данных нет, только тип сообщения
-	if (rx_size <= 1) {
-		*size = 0;
-	} else {
-		// Иначе копируем данные без учета типа сообщения
-		*size = rx_size - 1;
+#if SECUART_AGGREGATION
+	if (ctx->agg_count > 0 &&
+			(ctx->agg_flush_pending || HAL_GetTick() - ctx->agg_since >= ctx->agg_delay_ms)) {
+		SecUart_Flush(ctx);
+	}
+#endif
 
-        if (*size > 0) {
-            memcpy(data, ctx->rx_buffer + SECUART_HEADER_SIZE + 1, *size);
-            // Для текстовых данных добавляем завершающий нуль
-            if (data != NULL && *msg_type == SECUART_MSG_DATA) {
-                data[*size] = '\0';
-            }
-        }
+#if SECUART_ARQ
+	if (ctx->arq_ack_pending) {
+		SecUart_ArqSendAck(ctx);
 	}
 
-	// Обновляем счетчик
-	ctx->rx_counter = rx_counter;
-	ctx->rx_complete = false;
+	// Повтор фреймов, не подтвержденных за arq_timeout_ms
+	for (uint8_t seq = ctx->arq_tx_base; seq != ctx->arq_tx_next; seq++) {
+		SecUartArqSlot *arq = &ctx->arq_tx[seq & SECUART_ARQ_MASK];
 
-	// Увеличиваем счетчик принятых пакетов
-	ctx->packets_received++;
+		if (!arq->acked && HAL_GetTick() - arq->sent_at >= ctx->arq_timeout_ms) {
+			SecUart_ArqRetransmit(ctx, seq);
+		}
+	}
+#endif
+}
 
-	// Отладочное сообщение в монитор
-	char log_buffer[64];
-	snprintf(log_buffer, sizeof(log_buffer),
-			"RX: Counter=%lu, Size=%u, Type=%u\r\n",
-			rx_counter, *size, *msg_type);
-	SecUart_Log(ctx, log_buffer);
+#if SECUART_ARQ
+/**
+ * @brief Надежная отправка (selective repeat)
+ */
+SecUartError SecUart_SendReliable(SecUartContext *ctx,
+		const uint8_t *data,
+		uint8_t size,
+		SecUartMsgType msg_type) {
 
-	// Перезапускаем прием
-	SecUart_StartReceive(ctx);
+	if (ctx == NULL || data == NULL || size == 0) {
+		return SECUART_ERR_INVALID_SOF;
+	}
 
-	return SECUART_OK;
+	// Окно заполнено - ждем подтверждений. Пока SYN не подтвержден, узел
+	// еще может держать окно прошлого сеанса - в полете только SYN
+	uint8_t window = ctx->arq_tx_syn ? 1 : ctx->arq_window;
+	if ((uint8_t)(ctx->arq_tx_next - ctx->arq_tx_base) >= window) {
+		return SECUART_ERR_BUFFER_OVERFLOW;
+	}
+
+#if SECUART_AGGREGATION
+	// Накопленные SecUart_Post сообщения должны уйти раньше этого
+	if (ctx->agg_count > 0) {
+		SecUartError err = SecUart_Flush(ctx);
+		if (!SECUART_TX_QUEUED(err)) {
+			return err;
+		}
+	}
+#endif
+
+	// Заголовок получит флаг и номер ARQ (SecUart_BuildHeader)
+	ctx->arq_tx_mark = true;
+	SecUartError err = SecUart_SendFrame(ctx, data, size, msg_type);
+	ctx->arq_tx_mark = false;
+
+	// Фрейм в очереди и без запуска DMA - его номер ARQ уже занят
+	if (!SECUART_TX_QUEUED(err)) {
+		return err;
+	}
+
+	// Готовый шифротекст сохраняем для повторов. Слот очереди после
+	// SecUart_SendFrame содержит фрейм целиком, даже при сквозной передаче
+	const SecUartTxSlot *slot = &ctx->tx_queue[(ctx->tx_q_head - 1) & SECUART_TX_QUEUE_MASK];
+	SecUartArqSlot *arq = &ctx->arq_tx[ctx->arq_tx_next & SECUART_ARQ_MASK];
+
+	memcpy(arq->frame, slot->frame, slot->length);
+	arq->length = slot->length;
+	arq->sent_at = HAL_GetTick();
+	arq->acked = false;
+	ctx->arq_tx_next++;
+
+	return err;
 }
 
 /**
- * @brief Обработчик прерывания IDLE для UART
+ * @brief Постановка готового фрейма в очередь передачи без изменений
  */
-void SecUart_RxIdleCallback(SecUartContext *ctx, UART_HandleTypeDef *huart) {
-	if (ctx == NULL || huart != ctx->huart_rx) {
-		return;
+static SecUartError SecUart_EnqueueFrame(SecUartContext *ctx, const uint8_t *frame, uint16_t length) {
+	if (ctx->tx_q_head - ctx->tx_q_tail >= SECUART_TX_QUEUE_LEN) {
+		return SECUART_ERR_BUFFER_OVERFLOW;
 	}
 
-	// Отключаем прерывание IDLE
-	__HAL_UART_DISABLE_IT(huart, UART_IT_IDLE);
+	SecUartTxSlot *slot = &ctx->tx_queue[ctx->tx_q_head & SECUART_TX_QUEUE_MASK];
+	memcpy(slot->frame, frame, length);
+	slot->length = length;
 
-	// Останавливаем DMA
-	HAL_UART_AbortReceive(huart);
+	__DMB();
+	ctx->tx_q_head++;
+	SecUart_StartNextTx(ctx);
 
-	// Вычисляем количество принятых байт
-	uint32_t dma_index = __HAL_DMA_GET_COUNTER(huart->hdmarx);
-	ctx->rx_data_size = SECUART_BUFFER_SIZE - dma_index;
+	return SECUART_OK;
+}
 
-	// Проверяем минимальный размер принятых данных
-	// (заголовок + тип сообщения + MAC)
-	if (ctx->rx_data_size < SECUART_HEADER_SIZE + 1 + SECUART_MAC_SIZE) {
-		// Сбрасываем прием из-за недостаточного размера пакета
-		SecUart_StartReceive(ctx);
-		return;
+/**
+ * @brief Повтор надежного фрейма из сохраненного шифротекста
+ */
+static void SecUart_ArqRetransmit(SecUartContext *ctx, uint8_t seq) {
+	SecUartArqSlot *arq = &ctx->arq_tx[seq & SECUART_ARQ_MASK];
+
+	// Очередь полна - повторим при следующем SecUart_Poll
+	if (SecUart_EnqueueFrame(ctx, arq->frame, arq->length) == SECUART_OK) {
+		arq->sent_at = HAL_GetTick();
+		ctx->arq_retransmits++;
 	}
+}
 
-	// Устанавливаем флаг завершения приема
-	ctx->rx_complete = true;
+/**
+ * @brief Окно приема ARQ: отметка принятого номера
+ * @note Фрейм номера s отправлен позже фрейма s - 1, поэтому его CNT больше
+ *       CNT фрейма arq_rx_next - 1. Фрейм с тем же номером с прошлого круга
+ *       нумерации старше - это повтор, а не пропущенный фрейм.
+ *       Перезапуск узла: номера ARQ снова идут с нуля, а CNT продолжается
+ *       выше всех прежних (SECUART_CNT_PERSIST). Поэтому новый сеанс - это
+ *       SYN с CNT старше всех принятых надежных фреймов; повтор SYN текущего
+ *       сеанса идет с тем же CNT, SYN прошлых сеансов - с меньшим.
+ * @param syn Фрейм с SECUART_FLAG_SYN (номер 0 сеанса узла)
+ * @return SECUART_OK - новый фрейм; SECUART_ERR_TIMEOUT - дубликат;
+ *         SECUART_ERR_REPLAY - старый фрейм с номером из окна
+ */
+static SecUartError SecUart_ArqAccept(SecUartContext *ctx, uint8_t seq, uint32_t counter, bool syn) {
+	// Подтверждение нужно в любом случае: на дубликат - повторное
+	ctx->arq_ack_pending = true;
+
+	if (!ctx->arq_rx_synced || (syn && counter > ctx->arq_rx_top_cnt)) {
+		// Новый сеанс узла или первый фрейм после нашего перезапуска (сеанс
+		// узла мог начаться давно) - окно переносится на этот номер
+		ctx->arq_rx_next = seq;
+		ctx->arq_rx_map = 0;
+		ctx->arq_rx_base_cnt = 0;
+		ctx->arq_rx_top_cnt = counter;
+		ctx->arq_rx_synced = true;
+	}
 
-	// Отладочное сообщение в монитор
-	char log_buffer[64];
-	snprintf(log_buffer, sizeof(log_buffer),
-			"IDLE: Received %u bytes\r\n", ctx->rx_data_size);
-	SecUart_Log(ctx, log_buffer);
+	uint8_t d = seq - ctx->arq_rx_next;
+
+	if (d >= SECUART_ARQ_WINDOW) {
+		// Номер до окна - уже принят
+		return SECUART_ERR_TIMEOUT;
+	}
+	if (ctx->arq_rx_map & (1u << d)) {
+		return SECUART_ERR_TIMEOUT;
+	}
+	if (counter <= ctx->arq_rx_base_cnt) {
+		return SECUART_ERR_REPLAY;
+	}
+
+	if (counter > ctx->arq_rx_top_cnt) {
+		ctx->arq_rx_top_cnt = counter;
+	}
+	ctx->arq_rx_map |= 1u << d;
+	ctx->arq_rx_cnt[seq & SECUART_ARQ_MASK] = counter;
+
+	// Сдвиг окна по непрерывно принятым номерам
+	while (ctx->arq_rx_map & 1u) {
+		ctx->arq_rx_base_cnt = ctx->arq_rx_cnt[ctx->arq_rx_next & SECUART_ARQ_MASK];
+		ctx->arq_rx_map >>= 1;
+		ctx->arq_rx_next++;
+	}
+
+	return SECUART_OK;
 }
 
 /**
- * @brief Отправка отладочного сообщения через монитор
+ * @brief ACK, если все номера до arq_rx_next приняты подряд, иначе NACK с картой пропусков
  */
-void SecUart_Log(SecUartContext *ctx, const char *msg) {
-	if (ctx == NULL || ctx->huart_monitor == NULL || msg == NULL) {
-		return;
+static void SecUart_ArqSendAck(SecUartContext *ctx) {
+	uint8_t msg[SECUART_ARQ_NACK_SIZE];
+	uint32_t missing = 0;
+
+	msg[0] = ctx->arq_rx_next;
+
+	// Пропуски - номера до последнего принятого вне очереди
+	if (ctx->arq_rx_map != 0) {
+		uint32_t span = 32 - __CLZ(ctx->arq_rx_map);
+		missing = ~ctx->arq_rx_map & (span >= 32 ? UINT32_MAX : (1u << span) - 1);
 	}
 
-	HAL_UART_Transmit(ctx->huart_monitor, (uint8_t*)msg, strlen(msg), 100);
+	SecUartError err;
+	if (missing == 0) {
+		err = SecUart_SendFrame(ctx, msg, SECUART_ARQ_ACK_SIZE + 1, SECUART_MSG_ACK);
+	} else {
+		msg[1] = (missing >> 24) & 0xFF;
+		msg[2] = (missing >> 16) & 0xFF;
+		msg[3] = (missing >> 8) & 0xFF;
+		msg[4] = missing & 0xFF;
+		err = SecUart_SendFrame(ctx, msg, SECUART_ARQ_NACK_SIZE + 1, SECUART_MSG_NACK);
+	}
+
+	// Очередь полна - подтвердим при следующем SecUart_Poll
+	if (SECUART_TX_QUEUED(err)) {
+		ctx->arq_ack_pending = false;
+	}
 }
 
 /**
- * @brief Шифрование блока данных
+ * @brief Подтверждение от узла: сдвиг окна передачи, повтор пропущенных
  */
-static void SecUart_EncryptBlock(const SpeckContext *ctx, uint8_t *data, uint8_t size) {
-	uint8_t padded_size = ((size + SECUART_BLOCK_SIZE - 1) / SECUART_BLOCK_SIZE) * SECUART_BLOCK_SIZE;
+static void SecUart_ArqHandleAck(SecUartContext *ctx, SecUartMsgType msg_type, const uint8_t *data, uint8_t size) {
+	uint8_t in_flight = ctx->arq_tx_next - ctx->arq_tx_base;
 
-	// Обрабатываем данные блоками по 8 байт (64 бит)
-	for (uint8_t i = 0; i < padded_size; i += SECUART_BLOCK_SIZE) {
-		uint32_t block[2];
+	if (size < SECUART_ARQ_ACK_SIZE) {
+		return;
+	}
 
-		// Преобразуем 8 байт в два 32-битных слова
-		if (i + 3 < size) {
-			block[0] = ((uint32_t)data[i] << 24) |
-					((uint32_t)data[i+1] << 16) |
-					((uint32_t)data[i+2] << 8) |
-					data[i+3];
-		} else {
-			// Дополнение нулями, если недостаточно данных
-			block[0] = 0;
-			for (uint8_t j = 0; j < 4 && i + j < size; j++) {
-				block[0] |= ((uint32_t)data[i+j] << ((3-j) * 8));
-			}
-		}
+	// NEXT вне [base, next] - устаревшее или чужое подтверждение
+	uint8_t acked = data[0] - ctx->arq_tx_base;
+	if (acked > in_flight) {
+		return;
+	}
 
-		if (i + 7 < size) {
-			block[1] = ((uint32_t)data[i+4] << 24) |
-					((uint32_t)data[i+5] << 16) |
-					((uint32_t)data[i+6] << 8) |
-					data[i+7];
-		} else {
-			// Дополнение нулями, если недостаточно данных
-			block[1] = 0;
-			for (uint8_t j = 0; j < 4 && i + 4 + j < size; j++) {
-				block[1] |= ((uint32_t)data[i+4+j] << ((3-j) * 8));
-			}
-		}
+	// Накопительная часть: все номера до NEXT приняты
+	ctx->arq_tx_base = data[0];
 
-		// Шифруем блок
-		speck_encrypt(ctx, block);
+	// SYN принят - узел перешел на наш сеанс, окно открывается целиком
+	if (ctx->arq_tx_base != 0) {
+		ctx->arq_tx_syn = false;
+	}
 
-		// Преобразуем два 32-битных слова обратно в 8 байт
-		// и записываем обратно в буфер
-		if (i + 3 < size) {
-			data[i] = (block[0] >> 24) & 0xFF;
-			data[i+1] = (block[0] >> 16) & 0xFF;
-			data[i+2] = (block[0] >> 8) & 0xFF;
-			data[i+3] = block[0] & 0xFF;
-		} else {
-			// Записываем только нужное количество байт
-			for (uint8_t j = 0; j < 4 && i + j < size; j++) {
-				data[i+j] = (block[0] >> ((3-j) * 8)) & 0xFF;
+	if (msg_type == SECUART_MSG_NACK && size >= SECUART_ARQ_NACK_SIZE) {
+		uint32_t missing = ((uint32_t)data[1] << 24) | ((uint32_t)data[2] << 16) |
+				((uint32_t)data[3] << 8) | data[4];
+		uint32_t span = (missing != 0) ? 32 - __CLZ(missing) : 0;
+
+		for (uint8_t i = 0; i < span && i < (uint8_t)(ctx->arq_tx_next - ctx->arq_tx_base); i++) {
+			uint8_t seq = ctx->arq_tx_base + i;
+			SecUartArqSlot *arq = &ctx->arq_tx[seq & SECUART_ARQ_MASK];
+
+			if (!(missing & (1u << i))) {
+				arq->acked = true;
+			} else if (!arq->acked && HAL_GetTick() - arq->sent_at >= ctx->arq_timeout_ms / 4) {
+				// Пропуск: повторяем сразу, не дожидаясь тайм-аута, но не на
+				// каждый NACK подряд - повтор мог еще не дойти
+				SecUart_ArqRetransmit(ctx, seq);
 			}
 		}
+	}
 
-		if (i + 7 < size) {
-			data[i+4] = (block[1] >> 24) & 0xFF;
-			data[i+5] = (block[1] >> 16) & 0xFF;
-			data[i+6] = (block[1] >> 8) & 0xFF;
-			data[i+7] = block[1] & 0xFF;
-		} else {
-			// Записываем только нужное количество байт
-			for (uint8_t j = 0; j < 4 && i + 4 + j < size; j++) {
-				data[i+4+j] = (block[1] >> ((3-j) * 8)) & 0xFF;
-			}
-		}
+	// Окно сдвигается и по выборочно подтвержденным номерам
+	while (ctx->arq_tx_base != ctx->arq_tx_next && ctx->arq_tx[ctx->arq_tx_base & SECUART_ARQ_MASK].acked) {
+		ctx->arq_tx_base++;
 	}
 }
+#endif
 
 /**
- * @brief Расшифрование блока данных
+ * @brief Запуск DMA для первого фрейма очереди, если линия свободна
+ * @note Вызывается из SecUart_Send и из TxCplt. Прерывание TxCplt не может
+ *       прийти, пока DMA простаивает, поэтому проверка tx_complete без
+ *       блокировки безопасна на одном ядре.
  */
-static void SecUart_DecryptBlock(const SpeckContext *ctx, uint8_t *data, uint8_t size) {
-	uint8_t padded_size = ((size + SECUART_BLOCK_SIZE - 1) / SECUART_BLOCK_SIZE) * SECUART_BLOCK_SIZE;
+static HAL_StatusTypeDef SecUart_StartNextTx(SecUartContext *ctx) {
+	if (!ctx->tx_complete || ctx->tx_q_tail == ctx->tx_q_head) {
+		return HAL_OK;
+	}
 
-	// Обрабатываем данные блоками по 8 байт (64 бит)
-	for (uint8_t i = 0; i < padded_size; i += SECUART_BLOCK_SIZE) {
-		uint32_t block[2];
+	SecUartTxSlot *slot = &ctx->tx_queue[ctx->tx_q_tail & SECUART_TX_QUEUE_MASK];
 
-		// Преобразуем 8 байт в два 32-битных слова
-		if (i + 3 < size) {
-			block[0] = ((uint32_t)data[i] << 24) |
-					((uint32_t)data[i+1] << 16) |
-					((uint32_t)data[i+2] << 8) |
-					data[i+3];
-		} else {
-			// Дополнение нулями, если недостаточно данных
-			block[0] = 0;
-			for (uint8_t j = 0; j < 4 && i + j < size; j++) {
-				block[0] |= ((uint32_t)data[i+j] << ((3-j) * 8));
-			}
-		}
+#if SECUART_BULK
+	const uint8_t *frame = (slot->ext != NULL) ? slot->ext : slot->frame;
+#else
+	const uint8_t *frame = slot->frame;
+#endif
 
-		if (i + 7 < size) {
-			block[1] = ((uint32_t)data[i+4] << 24) |
-					((uint32_t)data[i+5] << 16) |
-					((uint32_t)data[i+6] << 8) |
-					data[i+7];
-		} else {
-			// Дополнение нулями, если недостаточно данных
-			block[1] = 0;
-			for (uint8_t j = 0; j < 4 && i + 4 + j < size; j++) {
-				block[1] |= ((uint32_t)data[i+4+j] << ((3-j) * 8));
-			}
-		}
+	ctx->tx_complete = false;
+	HAL_StatusTypeDef hal_status = HAL_UART_Transmit_DMA(ctx->huart_tx, frame, slot->length);
+	if (hal_status != HAL_OK) {
+		ctx->tx_complete = true;
+	}
 
-		// Расшифровываем блок
-		speck_decrypt(ctx, block);
+	return hal_status;
+}
 
-		// Преобразуем два 32-битных слова обратно в 8 байт
-		// и записываем обратно в буфер
-		if (i + 3 < size) {
-			data[i] = (block[0] >> 24) & 0xFF;
-			data[i+1] = (block[0] >> 16) & 0xFF;
-			data[i+2] = (block[0] >> 8) & 0xFF;
-			data[i+3] = block[0] & 0xFF;
-		} else {
-			// Записываем только нужное количество байт
-			for (uint8_t j = 0; j < 4 && i + j < size; j++) {
-				data[i+j] = (block[0] >> ((3-j) * 8)) & 0xFF;
-			}
+/**
+ * @brief Подготовка фрейма для отправки
+ */
+static uint8_t SecUart_PrepareFrame(SecUartContext *ctx, uint8_t *frame, const uint8_t *data, uint8_t size, SecUartMsgType msg_type) {
+	SecUartMac mac_ctx;
+
+	size = SecUart_BuildHeader(ctx, frame, NULL, data, size, msg_type);
+
+	// Шифрование данных и MAC для всего фрейма (заголовок + зашифрованные данные)
+	uint8_t hdr = SECUART_FRAME_HDR(frame);
+	SecUart_MacInit(ctx, &mac_ctx);
+	SecUart_MacHeader(ctx, &mac_ctx, frame, ctx->tx_counter, ctx->tx_dir);
+	SecUart_SealBlocks(ctx, &mac_ctx, frame, NULL, 0, size, 0);
+	SecUart_MacFinal(ctx, &mac_ctx, frame + hdr + size);
+
+	return size;
+}
+
+/**
+ * @brief Заполнение заголовка и открытых данных фрейма
+ * @param stage Куда положить открытый текст (тип + данные); NULL - в слот за
+ *        заголовком, пока слот не отдан DMA
+ */
+static uint8_t SecUart_BuildHeader(SecUartContext *ctx, uint8_t *frame, uint8_t *stage, const uint8_t *data, uint8_t size, SecUartMsgType msg_type) {
+	// Очистка слота передачи
+	memset(frame, 0, SECUART_BUFFER_SIZE);
+
+	ctx->tx_counter++;                            // Увеличиваем счетчик
+	uint8_t hdr;
+
+	// Номер ARQ есть только в заголовке v2
+	bool v2 = SECUART_TX_FRAME_V2;
+#if SECUART_ARQ
+	v2 = v2 || ctx->arq_tx_mark;
+#endif
+	bool lz = false;
+	uint8_t short_hdr = 0;
+
+#if SECUART_SHORT_CNT
+	// Короткий заголовок: только младшие биты CNT, приемник восстанавливает
+	// старшие по последнему принятому CNT. Первый фрейм и каждый
+	// SECUART_SHORT_SYNC-й идут с полным CNT, чтобы приемник, пропустивший
+	// много фреймов подряд, снова нашел опору. Флаги есть только у v2
+	bool full_cnt = ctx->tx_cnt_sync == 0 || ctx->tx_counter - ctx->tx_cnt_sync >= SECUART_SHORT_SYNC;
+#if SECUART_ARQ
+	full_cnt = full_cnt || ctx->arq_tx_mark;
+#endif
+	if (!full_cnt) {
+		short_hdr = (SECUART_SHORT_CNT == 8) ? SECUART_HEADER_SIZE_S8 : SECUART_HEADER_SIZE_S16;
+	}
+#endif
+
+#if SECUART_LZ
+	// Сжатие - только если данные становятся короче хотя бы на байт (а при
+	// доступном коротком заголовке - еще и на разницу заголовков), сразу на
+	// место открытого текста фрейма v2. Тип остается несжатым
+	uint8_t spare = short_hdr ? SECUART_HEADER_SIZE_V2 - short_hdr : 0;
+	if (v2 && ctx->tx_compress && size - 1 >= SECUART_LZ_MIN && size - 2 > spare) {
+		uint8_t *packed_dst = (stage != NULL) ? stage + 1 : frame + SECUART_HEADER_SIZE_V2 + 1;
+		size_t packed = Lzss_Compress(data, size - 1, packed_dst, size - 2 - spare);
+		if (packed != 0) {
+			size = (uint8_t)(packed + 1);
+			lz = true;
+			short_hdr = 0;
 		}
+	}
+#endif
 
-		if (i + 7 < size) {
-			data[i+4] = (block[1] >> 24) & 0xFF;
-			data[i+5] = (block[1] >> 16) & 0xFF;
-			data[i+6] = (block[1] >> 8) & 0xFF;
-			data[i+7] = block[1] & 0xFF;
-		} else {
-			// Записываем только нужное количество байт
-			for (uint8_t j = 0; j < 4 && i + 4 + j < size; j++) {
-				data[i+4+j] = (block[1] >> ((3-j) * 8)) & 0xFF;
+	// Заполнение заголовка
+	if (short_hdr != 0) {
+		frame[0] = (short_hdr == SECUART_HEADER_SIZE_S8) ? SECUART_START_BYTE_S8 : SECUART_START_BYTE_S16;
+		if (short_hdr == SECUART_HEADER_SIZE_S16) {
+			frame[1] = (ctx->tx_counter >> 8) & 0xFF; // CNT (младшие 16 бит)
+		}
+		frame[short_hdr - 2] = ctx->tx_counter & 0xFF;  // CNT (LSB)
+		frame[short_hdr - 1] = size;                  // LEN
+		hdr = short_hdr;
+	} else if (v2) {
+		// v2: CNT - выровненное слово, данные с frame + 8 (граница блока)
+		uint32_t cnt_be = __REV(ctx->tx_counter);
+		frame[0] = SECUART_START_BYTE_V2;         // SOF
+		frame[1] = 0;                             // FLAGS
+		frame[2] = 0;                             // RSV
+		frame[3] = size;                          // LEN
+		memcpy(frame + 4, &cnt_be, sizeof(cnt_be)); // CNT (big-endian)
+		hdr = SECUART_HEADER_SIZE_V2;
+#if SECUART_ARQ
+		if (ctx->arq_tx_mark) {
+			frame[1] = SECUART_FLAG_ARQ;
+			frame[2] = ctx->arq_tx_next;          // Номер ARQ
+			if (ctx->arq_tx_syn) {
+				frame[1] |= SECUART_FLAG_SYN;     // Номер 0 нового сеанса
 			}
 		}
+#endif
+		if (lz) {
+			frame[1] |= SECUART_FLAG_LZ;
+		}
+	} else {
+		frame[0] = SECUART_START_BYTE;            // SOF
+		frame[1] = (ctx->tx_counter >> 24) & 0xFF;    // CNT (MSB)
+		frame[2] = (ctx->tx_counter >> 16) & 0xFF;
+		frame[3] = (ctx->tx_counter >> 8) & 0xFF;
+		frame[4] = ctx->tx_counter & 0xFF;            // CNT (LSB)
+		frame[5] = size;                              // LEN
+		hdr = SECUART_HEADER_SIZE;
 	}
-}
+
+	if (short_hdr == 0) {
+		ctx->tx_cnt_sync = ctx->tx_counter;
+	}
+
+	// Копирование данных с учетом типа сообщения (сжатые уже на месте)
+	uint8_t *body = (stage != NULL) ? stage : frame + hdr;
+	body[0] = msg_type;                           // Тип сообщения
+	if (!lz && size > 1) {
+		memcpy(body + 1, data, size - 1);
+	}
+
+	return size;
+}
+
+/**
+ * @brief Шифрование блоков данных [from, to) и добавление их в MAC
+ * @param src Открытый текст вне слота (тип + данные) или NULL - шифрование
+ *        на месте в слоте, который еще не отдан DMA
+ * @param fence_len Длина фрейма, который уже читает DMA, или 0 без контроля
+ * @return false, если DMA пришлось оборвать (или он уже дочитал фрейм)
+ */
+static bool SecUart_SealBlocks(SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *frame, const uint8_t *src, uint16_t from, uint16_t to, uint16_t fence_len) {
+	bool in_time = true;
+	uint16_t step = SECUART_SUITE(ctx)->block_size;
+	uint8_t hdr = SECUART_FRAME_HDR(frame);
+
+	for (uint16_t i = from; i < to; i += step) {
+		uint8_t *block = frame + hdr + i;
+		uint8_t n = (to - i < step) ? (uint8_t)(to - i) : (uint8_t)step;
+
+		// Забор по NDTR: DMA не должен подойти к блоку, который еще не
+		// зашифрован (там нули). Слишком близко - обрываем передачу
+		if (fence_len != 0 && SecUart_TxReadPos(ctx, fence_len) + SECUART_TX_FENCE_GUARD > hdr + i) {
+			SecUart_AbortTx(ctx);
+			fence_len = 0;
+			in_time = false;
+		}
+
+		if (src != NULL) {
+			// Открытый текст не попадает в память, которую читает DMA: блок
+			// шифруется в стеке, в слот пишется уже шифротекст
+			uint32_t sealed[SECUART_BLOCK_SIZE / 4];
+			memcpy(sealed, src + i, n);
+			SecUart_PayloadCrypt(ctx, true, ctx->tx_counter, i, (uint8_t *)sealed, n);
+			memcpy(block, sealed, n);
+		} else {
+			SecUart_PayloadCrypt(ctx, true, ctx->tx_counter, i, block, n);
+		}
+		SecUart_MacUpdate(ctx, mac_ctx, block, n);
+	}
+
+	return in_time;
+}
+
+#if SECUART_TX_CUT_THROUGH
+/**
+ * @brief Сквозная передача: DMA стартует на заголовке, шифрование идет следом
+ * @note Вызывается только при пустой очереди и свободной линии
+ */
+static HAL_StatusTypeDef SecUart_SendCutThrough(SecUartContext *ctx, SecUartTxSlot *slot, const uint8_t *data, uint8_t size, SecUartMsgType msg_type, uint32_t *first_byte_cycles, uint32_t *total_cycles) {
+	SecUartMac mac_ctx;
+	uint32_t t0 = DWT->CYCCNT;
+
+	// Заголовок и первый блок готовим до старта DMA. Открытый текст - в
+	// tx_stage: в слоте за заголовком до шифрования остаются нули
+	size = SecUart_BuildHeader(ctx, slot->frame, ctx->tx_stage, data, size, msg_type);
+	uint8_t hdr = SECUART_FRAME_HDR(slot->frame);
+	uint16_t frame_len = hdr + size + SECUART_SUITE(ctx)->tag_size;
+	uint16_t step = SECUART_SUITE(ctx)->block_size;
+	uint16_t first = (size < step) ? size : step;
+	SecUart_MacInit(ctx, &mac_ctx);
+	SecUart_MacHeader(ctx, &mac_ctx, slot->frame, ctx->tx_counter, ctx->tx_dir);
+	SecUart_SealBlocks(ctx, &mac_ctx, slot->frame, ctx->tx_stage, 0, first, 0);
+
+	uint32_t index = ctx->tx_q_head;
+	slot->length = frame_len;
+	__DMB();
+	ctx->tx_q_head++;
+
+	HAL_StatusTypeDef hal_status = SecUart_StartNextTx(ctx);
+	*first_byte_cycles = DWT->CYCCNT - t0;
+
+	// Остальные блоки и MAC дописываются, пока DMA передает начало фрейма.
+	// Если DMA не стартовал, фрейм просто остается в очереди целиком
+	uint16_t fence_len = (hal_status == HAL_OK) ? frame_len : 0;
+	bool in_time = SecUart_SealBlocks(ctx, &mac_ctx, slot->frame, ctx->tx_stage, first, size, fence_len);
+	if (in_time && fence_len != 0 && SecUart_TxReadPos(ctx, frame_len) + SECUART_TX_FENCE_GUARD > hdr + size) {
+		SecUart_AbortTx(ctx);
+		in_time = false;
+	}
+	SecUart_MacFinal(ctx, &mac_ctx, slot->frame + hdr + size);
+	if (in_time && fence_len != 0 && SecUart_TxReadPos(ctx, frame_len) > hdr + size) {
+		// DMA забрал MAC раньше, чем он был дописан: обрываем так же, как
+		// перед MAC, иначе недописанный фрейм ушел бы без повтора
+		SecUart_AbortTx(ctx);
+		in_time = false;
+	}
+	memset(ctx->tx_stage, 0, size);
+	*total_cycles = DWT->CYCCNT - t0;
+
+	if (!in_time) {
+		// DMA догнал шифрование (например, из-за долгого прерывания). На
+		// линию ушли только заголовок и шифротекст (или нули недописанных
+		// блоков), приемник отбросит обрывок по MAC. Готовый фрейм уходит
+		// заново с тем же счетчиком: обрывок не был принят, это не повтор
+		ctx->tx_late++;
+		if (ctx->tx_q_tail != index) {
+			// DMA успел дочитать фрейм до обрыва - слот уже свободен, ставим копию
+			SecUartTxSlot *retry = &ctx->tx_queue[ctx->tx_q_head & SECUART_TX_QUEUE_MASK];
+			memcpy(retry->frame, slot->frame, frame_len);
+			retry->length = frame_len;
+			__DMB();
+			ctx->tx_q_head++;
+		}
+		hal_status = SecUart_StartNextTx(ctx);
+	}
+
+	return hal_status;
+}
+#endif
+
+/**
+ * @brief Сколько байт фрейма DMA2_Stream7 уже забрал из памяти
+ */
+static uint16_t SecUart_TxReadPos(SecUartContext *ctx, uint16_t length) {
+	// Если TxCplt уже вернул слот, DMA прочитал фрейм целиком
+	if (ctx->tx_complete) {
+		return length;
+	}
+	return length - (uint16_t)__HAL_DMA_GET_COUNTER(ctx->huart_tx->hdmatx);
+}
+
+/**
+ * @brief Обрыв передачи фрейма, до которого DMA дошел раньше шифрования
+ * @note Слот остается первым в очереди и уйдет заново целиком. Поток
+ *       останавливается напрямую: HAL_UART_AbortTransmit ждет его по
+ *       HAL_GetTick, а при запрещенных прерываниях SysTick не идет
+ */
+static void SecUart_AbortTx(SecUartContext *ctx) {
+	UART_HandleTypeDef *huart = ctx->huart_tx;
+	DMA_HandleTypeDef *hdma = huart->hdmatx;
+	DMA_Stream_TypeDef *stream = hdma->Instance;
+	bool aborted = false;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	// TxCplt мог успеть прийти - тогда обрывать уже нечего
+	if (!ctx->tx_complete) {
+		// Без прерываний потока TxCplt по этому фрейму уже не придет
+		stream->CR &= ~(DMA_SxCR_TCIE | DMA_SxCR_HTIE | DMA_SxCR_TEIE | DMA_SxCR_DMEIE | DMA_SxCR_EN);
+		stream->FCR &= ~DMA_SxFCR_FEIE;
+		for (uint32_t n = 0; (stream->CR & DMA_SxCR_EN) != 0 && n < SECUART_TX_ABORT_POLL; n++) {
+		}
+		__HAL_DMA_CLEAR_FLAG(hdma, __HAL_DMA_GET_TC_FLAG_INDEX(hdma) | __HAL_DMA_GET_HT_FLAG_INDEX(hdma) |
+				__HAL_DMA_GET_TE_FLAG_INDEX(hdma) | __HAL_DMA_GET_FE_FLAG_INDEX(hdma) | __HAL_DMA_GET_DME_FLAG_INDEX(hdma));
+		aborted = true;
+	}
+
+	__set_PRIMASK(primask);
+
+	if (aborted) {
+		// Остальное - как в HAL_UART_AbortTransmit: поток уже стоит
+		ATOMIC_CLEAR_BIT(huart->Instance->CR1, USART_CR1_TXEIE | USART_CR1_TCIE);
+		ATOMIC_CLEAR_BIT(huart->Instance->CR3, USART_CR3_DMAT);
+		huart->TxXferCount = 0;
+		hdma->State = HAL_DMA_STATE_READY;
+		__HAL_UNLOCK(hdma);
+		huart->gState = HAL_UART_STATE_READY;
+		ctx->tx_complete = true;
+	}
+}
+
+/**
+ * @brief Обработка принятых данных
+ */
+SecUartError SecUart_ProcessRxData(SecUartContext *ctx,
+		uint8_t *data,
+		uint8_t *size,
+		SecUartMsgType *msg_type) {
+
+	if (ctx == NULL || data == NULL || size == NULL || msg_type == NULL) {
+		return SECUART_ERR_INVALID_SOF;
+	}
+
+	SecUartRxSlot *slot;
+	const uint8_t *frame;
+	uint32_t rx_counter;
+	bool first;
+
+	// Дубликаты ARQ пропускаются в цикле, а не рекурсией: в Debug (-O0)
+	// каждый уровень занимал бы стек, а их в кольце может быть много подряд
+	for (;;) {
+#if SECUART_BULK
+		// Данные прошлого длинного сообщения больше не нужны приложению
+		SecUart_BulkRelease(ctx);
+#endif
+
+		// Проверяем флаг завершения приема
+		if (!ctx->rx_complete) {
+			return SECUART_ERR_TIMEOUT;
+		}
+
+		// Флаг сбрасываем до проверки очереди, чтобы не потерять событие из прерывания
+		ctx->rx_complete = false;
+
+		// Ошибки, найденные в прерывании, отдаем по одной
+		SecUartError rx_error = ctx->rx_error;
+		if (rx_error != SECUART_OK) {
+			ctx->rx_error = SECUART_OK;
+			if (ctx->rx_q_tail != ctx->rx_q_head) {
+				ctx->rx_complete = true;
+			}
+
+			SecUart_Log(ctx, rx_error == SECUART_ERR_INVALID_MAC ? "ERR: Invalid MAC\r\n" :
+					rx_error == SECUART_ERR_ROLE ? "ERR: Peer has the same SECUART_NODE_ROLE\r\n" :
+					"ERR: RX ring overrun\r\n");
+			return rx_error;
+		}
+
+		if (ctx->rx_q_tail == ctx->rx_q_head) {
+			return SECUART_ERR_TIMEOUT;
+		}
+
+		// Фрейм уже прошел MAC и расшифрован в прерывании
+		slot = &ctx->rx_queue[ctx->rx_q_tail & SECUART_RX_QUEUE_MASK];
+		frame = slot->frame;
+
+		// Счетчик фрейма (прерывание восстановило его и для короткого заголовка)
+		rx_counter = slot->counter;
+
+#if SECUART_BULK
+		// Буфер сборки уходит приложению вместе со слотом и освобождается
+		// следующим вызовом, даже если фрейм будет отброшен
+		if (slot->bulk != NULL) {
+			ctx->rx_bulk_held = slot->bulk;
+		}
+#endif
+
+		// Первое обращение к фрейму (у агрегата следующие вложенные сообщения
+		// идут с тем же счетчиком и повтором не являются)
+		first = (ctx->rx_agg_pos == 0);
+		if (!first) {
+			break;
+		}
+
+		SecUartError accept_error;
+
+#if SECUART_ARQ
+		// Надежный фрейм: повтор по ARQ приходит со старым CNT, дубликаты
+		// отсеивает окно приема ARQ
+		if (SECUART_FRAME_IS_ARQ(frame)) {
+			accept_error = SecUart_ArqAccept(ctx, frame[2], rx_counter, SECUART_FRAME_IS_SYN(frame));
+		} else {
+			accept_error = SecUart_ReplayCheck(ctx, rx_counter) ? SECUART_OK : SECUART_ERR_REPLAY;
+		}
+#else
+		// Проверяем защиту от Replay-атак (счетчик уже принят или старше окна)
+		accept_error = SecUart_ReplayCheck(ctx, rx_counter) ? SECUART_OK : SECUART_ERR_REPLAY;
+#endif
+
+		if (accept_error == SECUART_ERR_TIMEOUT) {
+			// Дубликат ARQ (узел не получил наш ACK) - молча к следующему фрейму
+			SecUart_ReleaseRxSlot(ctx);
+			continue;
+		}
+		if (accept_error != SECUART_OK) {
+			ctx->errors_detected++;
+			SecUart_ReleaseRxSlot(ctx);
+
+			char log_buffer[64];
+			snprintf(log_buffer, sizeof(log_buffer),
+					"ERR: Replay attack detected (%lu, last %lu)\r\n",
+					rx_counter, ctx->rx_counter);
+			SecUart_Log(ctx, log_buffer);
+
+			return accept_error;
+		}
+
+		break;
+	}
+
+	uint8_t rx_size = SECUART_FRAME_LEN(frame);
+	uint8_t hdr = SECUART_FRAME_HDR(frame);
+	bool last = true;
+
+	// Данные после байта типа (у сжатого фрейма - распакованные)
+	const uint8_t *body = frame + hdr + 1;
+	uint8_t body_size = (rx_size > 1) ? rx_size - 1 : 0;
+
+	if (first) {
+#if SECUART_CYCLE_LOG
+		char cycles_msg[64];
+		snprintf(cycles_msg, sizeof(cycles_msg), "Cycles used (MAC+DECRYPT after last byte): %lu\r\n", slot->crypto_cycles);
+		SecUart_Log(ctx, cycles_msg);
+#endif
+
+#if SECUART_LZ
+		// Распаковка один раз на фрейм: сообщения агрегата берутся из rx_lz
+		if (SECUART_FRAME_IS_LZ(frame)) {
+			size_t unpacked = Lzss_Decompress(body, body_size, ctx->rx_lz, SECUART_MAX_DATA_SIZE - 1);
+
+			if (unpacked == 0) {
+				// MAC верен, значит, ошибка у отправителя
+				ctx->errors_detected++;
+				SecUart_ReplayUpdate(ctx, rx_counter);
+				SecUart_ReleaseRxSlot(ctx);
+				SecUart_Log(ctx, "ERR: Malformed compressed data\r\n");
+				return SECUART_ERR_MALFORMED;
+			}
+			ctx->rx_lz_len = (uint8_t)unpacked;
+		}
+#endif
+	}
+
+#if SECUART_LZ
+	if (SECUART_FRAME_IS_LZ(frame)) {
+		body = ctx->rx_lz;
+		body_size = ctx->rx_lz_len;
+	}
+#endif
+
+	// Извлекаем тип сообщения
+	*msg_type = (SecUartMsgType)frame[hdr];
+
+#if SECUART_BULK
+	if (slot->bulk != NULL) {
+		// Длинное сообщение не копируется: данные - через SecUart_BulkData
+		*size = 0;
+		ctx->rx_bulk_data = slot->bulk->data + 1;
+		ctx->rx_bulk_size = slot->bulk_len - 1;
+
+		SecUart_ReplayUpdate(ctx, rx_counter);
+		SecUart_ReleaseRxSlot(ctx);
+		ctx->packets_received++;
+
+		char log_buffer[64];
+		snprintf(log_buffer, sizeof(log_buffer),
+				"RX: Counter=%lu, Bulk size=%u, Type=%u\r\n",
+				rx_counter, ctx->rx_bulk_size, *msg_type);
+		SecUart_Log(ctx, log_buffer);
+
+		return SECUART_OK;
+	}
+#endif
+
+	if (*msg_type == SECUART_MSG_AGGREGATE) {
+		// Агрегат отдаем по одному вложенному сообщению за вызов
+		SecUartError agg_error = SecUart_NextAggregated(ctx, body, body_size,
+				data, size, msg_type, &last);
+
+		if (agg_error != SECUART_OK) {
+			// MAC верен, значит, ошибка у отправителя: остаток агрегата бросаем,
+			// счетчик фрейма считаем использованным
+			ctx->errors_detected++;
+			SecUart_ReplayUpdate(ctx, rx_counter);
+			ctx->rx_agg_pos = 0;
+			SecUart_ReleaseRxSlot(ctx);
+			SecUart_Log(ctx, "ERR: Malformed aggregate\r\n");
+			return agg_error;
+		}
+	}
+	// Если размер данных равен 0 или 1, то данных нет, только тип сообщения
+	else if (body_size == 0) {
+		*size = 0;
+	} else {
+		// Иначе копируем данные без учета типа сообщения
+		*size = body_size;
+
+        if (*size > 0) {
+            memcpy(data, body, *size);
+            // Для текстовых данных добавляем завершающий нуль
+            if (data != NULL && *msg_type == SECUART_MSG_DATA) {
+                data[*size] = '\0';
+            }
+        }
+	}
+
+	// Отмечаем счетчик в окне и возвращаем слот прерыванию после последнего сообщения
+	SecUart_ReplayUpdate(ctx, rx_counter);
+	if (last) {
+		ctx->rx_agg_pos = 0;
+		SecUart_ReleaseRxSlot(ctx);
+
+		// Увеличиваем счетчик принятых пакетов
+		ctx->packets_received++;
+	} else {
+		ctx->rx_complete = true;
+	}
+
+#if SECUART_ARQ
+	// Подтверждения ARQ обрабатываем сами, сообщение все равно отдаем приложению
+	if (*msg_type == SECUART_MSG_ACK || *msg_type == SECUART_MSG_NACK) {
+		SecUart_ArqHandleAck(ctx, *msg_type, data, *size);
+	}
+#endif
+
+	// Отладочное сообщение в монитор
+	char log_buffer[64];
+	snprintf(log_buffer, sizeof(log_buffer),
+			"RX: Counter=%lu, Size=%u, Type=%u\r\n",
+			rx_counter, *size, *msg_type);
+	SecUart_Log(ctx, log_buffer);
+
+	return SECUART_OK;
+}
+
+/**
+ * @brief Очередное вложенное сообщение агрегата
+ * @param agg Данные агрегата (после байта типа)
+ * @param agg_size Их длина
+ * @param last Сообщение последнее - слот можно освобождать
+ * @return SECUART_ERR_MALFORMED, если подзаголовок или данные выходят за агрегат
+ */
+static SecUartError SecUart_NextAggregated(SecUartContext *ctx, const uint8_t *agg, uint8_t agg_size, uint8_t *data, uint8_t *size, SecUartMsgType *msg_type, bool *last) {
+	uint16_t pos = ctx->rx_agg_pos;
+
+	if (pos + SECUART_AGG_SUBHDR_SIZE > agg_size ||
+			pos + SECUART_AGG_SUBHDR_SIZE + agg[pos] > agg_size) {
+		return SECUART_ERR_MALFORMED;
+	}
+
+	*size = agg[pos];
+	*msg_type = (SecUartMsgType)agg[pos + 1];
+	memcpy(data, agg + pos + SECUART_AGG_SUBHDR_SIZE, *size);
+	// Для текстовых данных добавляем завершающий нуль
+	if (*msg_type == SECUART_MSG_DATA) {
+		data[*size] = '\0';
+	}
+
+	pos += SECUART_AGG_SUBHDR_SIZE + *size;
+	ctx->rx_agg_pos = pos;
+	*last = (pos >= agg_size);
+
+	return SECUART_OK;
+}
+
+/**
+ * @brief Освобождение первого слота очереди приема
+ * @note Если прерывание остановило разбор из-за заполненной очереди,
+ *       продолжаем его здесь с запрещенными прерываниями
+ */
+static void SecUart_ReleaseRxSlot(SecUartContext *ctx) {
+	__DMB();
+	ctx->rx_q_tail++;
+
+	SecUart_ResumeRx(ctx);
+
+	if (ctx->rx_q_tail != ctx->rx_q_head || ctx->rx_error != SECUART_OK) {
+		ctx->rx_complete = true;
+	}
+}
+
+/**
+ * @brief Продолжение разбора кольца, приостановленного из-за занятых буферов
+ */
+static void SecUart_ResumeRx(SecUartContext *ctx) {
+	if (ctx->rx_stalled) {
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		ctx->rx_stalled = false;
+		SecUart_RxPump(ctx);
+		__set_PRIMASK(primask);
+	}
+}
+
+#if SECUART_BULK
+/**
+ * @brief Буфер сборки для длинного фрейма (контекст прерывания приема)
+ * @return NULL - все буферы у приложения
+ */
+static SecUartBulkBuffer *SecUart_BulkAlloc(SecUartContext *ctx) {
+	// Буфер битого или прерванного фрейма остался за прерыванием
+	if (ctx->rx_bulk_cur != NULL) {
+		return ctx->rx_bulk_cur;
+	}
+
+	for (uint8_t i = 0; i < SECUART_BULK_POOL_LEN; i++) {
+		if (!ctx->rx_bulk_pool[i].busy) {
+			ctx->rx_bulk_pool[i].busy = true;
+			ctx->rx_bulk_cur = &ctx->rx_bulk_pool[i];
+			return ctx->rx_bulk_cur;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Возврат буфера сборки, отданного приложению
+ */
+static void SecUart_BulkRelease(SecUartContext *ctx) {
+	ctx->rx_bulk_data = NULL;
+	ctx->rx_bulk_size = 0;
+
+	if (ctx->rx_bulk_held == NULL) {
+		return;
+	}
+
+	// Открытый текст не остается в освобожденном буфере
+	memset(ctx->rx_bulk_held->data, 0, sizeof(ctx->rx_bulk_held->data));
+	__DMB();
+	ctx->rx_bulk_held->busy = false;
+	ctx->rx_bulk_held = NULL;
+}
+
+/**
+ * @brief Данные длинного сообщения
+ */
+const uint8_t *SecUart_BulkData(const SecUartContext *ctx, uint16_t *size) {
+	if (ctx == NULL || ctx->rx_bulk_data == NULL) {
+		return NULL;
+	}
+
+	if (size != NULL) {
+		*size = ctx->rx_bulk_size;
+	}
+	return ctx->rx_bulk_data;
+}
+#endif
+
+/**
+ * @brief Разбор новых байт кольца (контекст прерывания приема)
+ */
+static void SecUart_RxPump(SecUartContext *ctx) {
+	uint32_t head = ctx->rx_head;
+
+	// DMA обогнал потребителя на целый круг - старые данные уже перезаписаны
+	if (head - ctx->rx_tail > SECUART_RX_RING_SIZE) {
+		ctx->rx_overruns++;
+		ctx->errors_detected++;
+		ctx->rx_tail = head;
+		ctx->rx_state = SECUART_RX_HUNT_SOF;
+		ctx->rx_error = SECUART_ERR_BUFFER_OVERFLOW;
+		ctx->rx_complete = true;
+		return;
+	}
+
+	while (ctx->rx_tail != head) {
+		// Все слоты заняты приложением - ждем, байты остаются в кольце
+		if (ctx->rx_q_head - ctx->rx_q_tail >= SECUART_RX_QUEUE_LEN) {
+			ctx->rx_stalled = true;
+			return;
+		}
+
+		SecUartRxSlot *slot = &ctx->rx_queue[ctx->rx_q_head & SECUART_RX_QUEUE_MASK];
+		if (SecUart_ParseRxStream(ctx, slot->frame, head)) {
+			SecUart_FinishRxFrame(ctx, slot);
+		}
+	}
+}
+
+/**
+ * @brief Потоковый разбор кольца приема
+ * @param frame Слот, в котором собирается фрейм
+ * @return true, если в слоте собран полный фрейм
+ */
+static bool SecUart_ParseRxStream(SecUartContext *ctx, uint8_t *frame, uint32_t head) {
+	while (ctx->rx_tail != head) {
+		uint8_t byte = ctx->rx_ring[ctx->rx_tail & SECUART_RX_RING_MASK];
+
+		switch (ctx->rx_state) {
+		case SECUART_RX_HUNT_SOF:
+			if (SecUart_IsSof(byte)) {
+				ctx->rx_frame_start = ctx->rx_tail;
+				frame[0] = byte;
+				ctx->rx_frame_pos = 1;
+				ctx->rx_state = SECUART_RX_HEADER;
+			}
+			ctx->rx_tail++;
+			break;
+
+		case SECUART_RX_HEADER: {
+			uint8_t hdr = SECUART_FRAME_HDR(frame);
+
+			frame[ctx->rx_frame_pos++] = byte;
+			ctx->rx_tail++;
+			if (ctx->rx_frame_pos == hdr) {
+				bool short_cnt = SECUART_FRAME_IS_SHORT(frame);
+				bool ext = SECUART_FRAME_IS_EXT(frame);
+				uint32_t counter = 0;
+				bool counter_ok = !short_cnt || SecUart_ExpandCounter(ctx, frame, &counter);
+				uint16_t len = ext ? SECUART_FRAME_EXT_LEN(frame) : SECUART_FRAME_LEN(frame);
+
+				// LEN = 0 недопустим: тип сообщения есть всегда. Неизвестные
+				// флаги v2, RSV без номера ARQ, SYN не у номера 0 - такой
+				// фрейм не наш. Короткий заголовок до первого полного CNT или
+				// с CNT далеко от опоры (скорее всего, ложный SOF) не восстановить.
+				// Длинный фрейм - без других флагов, с LEN больше обычного,
+				// сошедшимся ~LEN и нулями: иначе ложный SOF занял бы прием на килобайты
+				if (len == 0 || !counter_ok ||
+						(ext && (frame[1] != SECUART_FLAG_EXT || len <= SECUART_MAX_DATA_SIZE || len > SECUART_BULK_MAX_SIZE ||
+						(frame[8] ^ frame[2]) != 0xFF || (frame[9] ^ frame[3]) != 0xFF || frame[10] != 0 || frame[11] != 0)) ||
+						(SECUART_FRAME_IS_V2(frame) && !ext &&
+						((frame[1] & ~SECUART_V2_FLAGS) != 0 ||
+						(!SECUART_FRAME_IS_ARQ(frame) && frame[2] != 0) ||
+						(SECUART_FRAME_IS_SYN(frame) && (!SECUART_FRAME_IS_ARQ(frame) || frame[2] != 0))))) {
+					ctx->errors_detected++;
+					SecUart_ResyncRx(ctx);
+					break;
+				}
+
+				ctx->rx_payload = frame + hdr;
+				ctx->rx_data_len = len;
+				ctx->rx_frame_len = hdr + len + SECUART_SUITE(ctx)->tag_size;
+				ctx->rx_state = SECUART_RX_BODY;
+#if SECUART_BULK
+				if (ext) {
+					SecUartBulkBuffer *bulk = SecUart_BulkAlloc(ctx);
+
+					// Все буферы у приложения: фрейм пропускаем целиком, а не
+					// останавливаем кольцо - обычные фреймы за ним не ждут
+					if (bulk == NULL) {
+						ctx->rx_bulk_dropped++;
+						ctx->errors_detected++;
+						ctx->rx_state = SECUART_RX_SKIP;
+						break;
+					}
+					ctx->rx_payload = bulk->data;
+				}
+#endif
+
+				// MAC покрывает заголовок (с полным CNT) - начинаем считать его сразу
+				ctx->rx_crypt_pos = 0;
+				ctx->rx_frame_cnt = short_cnt ? counter : SecUart_FrameCounter(frame);
+				SecUart_MacInit(ctx, &ctx->rx_mac);
+				SecUart_MacHeader(ctx, &ctx->rx_mac, frame, ctx->rx_frame_cnt, ctx->rx_dir);
+				if (!ctx->rx_role_ok) {
+					SecUart_MacInit(ctx, &ctx->rx_mac_own);
+					SecUart_MacHeader(ctx, &ctx->rx_mac_own, frame, ctx->rx_frame_cnt, ctx->tx_dir);
+				}
+			}
+			break;
+		}
+
+		case SECUART_RX_BODY: {
+			// Копируем сразу столько, сколько есть и сколько нужно фрейму
+			uint32_t need = ctx->rx_frame_len - ctx->rx_frame_pos;
+			uint32_t have = head - ctx->rx_tail;
+			uint32_t n = (have < need) ? have : need;
+
+			// Данные и MAC - в rx_payload (за заголовком в слоте или в буфер сборки)
+			uint8_t *dst = ctx->rx_payload + (ctx->rx_frame_pos - SECUART_FRAME_HDR(frame));
+			for (uint32_t i = 0; i < n; i++) {
+				dst[i] = ctx->rx_ring[(ctx->rx_tail + i) & SECUART_RX_RING_MASK];
+			}
+			ctx->rx_frame_pos += n;
+			ctx->rx_tail += n;
+
+			// Полные блоки шифротекста обрабатываем не дожидаясь конца фрейма
+			SecUart_RxCryptBlocks(ctx, ctx->rx_frame_pos - SECUART_FRAME_HDR(frame));
+
+			if (ctx->rx_frame_pos == ctx->rx_frame_len) {
+				ctx->rx_state = SECUART_RX_HUNT_SOF;
+				return true;
+			}
+			break;
+		}
+
+#if SECUART_BULK
+		case SECUART_RX_SKIP: {
+			uint32_t need = ctx->rx_frame_len - ctx->rx_frame_pos;
+			uint32_t have = head - ctx->rx_tail;
+			uint32_t n = (have < need) ? have : need;
+
+			ctx->rx_frame_pos += n;
+			ctx->rx_tail += n;
+			if (ctx->rx_frame_pos == ctx->rx_frame_len) {
+				ctx->rx_state = SECUART_RX_HUNT_SOF;
+			}
+			break;
+		}
+#endif
+
+		default:
+			ctx->rx_state = SECUART_RX_HUNT_SOF;
+			break;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * @brief MAC и расшифрование всех полных блоков данных, уже лежащих в rx_payload
+ * @param limit Сколько байт после заголовка уже принято
+ */
+static void SecUart_RxCryptBlocks(SecUartContext *ctx, uint16_t limit) {
+	uint16_t data_size = ctx->rx_data_len;
+	uint8_t *payload = ctx->rx_payload;
+	uint16_t step = SECUART_SUITE(ctx)->block_size;
+	if (limit > data_size) {
+		limit = data_size;
+	}
+
+	while (ctx->rx_crypt_pos + step <= limit) {
+		uint8_t *block = payload + ctx->rx_crypt_pos;
+
+		// MAC считается по шифротексту, поэтому сначала MAC, затем расшифрование на месте
+		SecUart_MacUpdate(ctx, &ctx->rx_mac, block, step);
+		if (!ctx->rx_role_ok) {
+			SecUart_MacUpdate(ctx, &ctx->rx_mac_own, block, step);
+		}
+		SecUart_PayloadCrypt(ctx, false, ctx->rx_frame_cnt,
+				ctx->rx_crypt_pos, block, step);
+		ctx->rx_crypt_pos += step;
+	}
+}
+
+/**
+ * @brief Завершение фрейма: последний неполный блок, проверка MAC, публикация
+ */
+static void SecUart_FinishRxFrame(SecUartContext *ctx, SecUartRxSlot *slot) {
+	uint8_t *frame = slot->frame;
+	uint16_t data_size = ctx->rx_data_len;
+	uint8_t *payload = ctx->rx_payload;
+	uint8_t *tail = payload + ctx->rx_crypt_pos;
+	uint8_t tail_size = data_size - ctx->rx_crypt_pos;
+
+	uint32_t t0 = DWT->CYCCNT;
+
+	// Остаток шифротекста (меньше блока) в MAC, затем сверка с принятым MAC
+	SecUart_MacUpdate(ctx, &ctx->rx_mac, tail, tail_size);
+	bool mac_valid = SecUart_VerifyMAC(ctx, &ctx->rx_mac, payload + data_size);
+	bool role_mismatch = false;
+
+	if (!ctx->rx_role_ok) {
+		// Пока роль узла на другом конце не подтверждена, MAC проверяется и
+		// со своим битом направления: так сходится фрейм узла с той же ролью
+		// (та же прошивка) или собственный фрейм на петле
+		SecUart_MacUpdate(ctx, &ctx->rx_mac_own, tail, tail_size);
+		if (mac_valid) {
+			ctx->rx_role_ok = true;
+		} else {
+			role_mismatch = SecUart_VerifyMAC(ctx, &ctx->rx_mac_own, payload + data_size);
+		}
+	}
+
+	if (!mac_valid) {
+		// Уничтожаем уже расшифрованный открытый текст - он не прошел проверку.
+		// Буфер сборки остается за прерыванием для следующего длинного фрейма
+		if (payload != frame + SECUART_FRAME_HDR(frame)) {
+			memset(payload, 0, data_size);
+		}
+		memset(frame, 0, SECUART_BUFFER_SIZE);
+
+		// Возможно, SOF был ложным - ищем следующий начиная с байта после него
+		ctx->errors_detected++;
+		if (role_mismatch) {
+			ctx->rx_role_mismatch++;
+		}
+		ctx->rx_error = role_mismatch ? SECUART_ERR_ROLE : SECUART_ERR_INVALID_MAC;
+		ctx->rx_complete = true;
+		SecUart_ResyncRx(ctx);
+		return;
+	}
+
+	if (tail_size > 0) {
+		SecUart_PayloadCrypt(ctx, false, ctx->rx_frame_cnt, ctx->rx_crypt_pos, tail, tail_size);
+	}
+
+	slot->crypto_cycles = DWT->CYCCNT - t0;
+	slot->counter = ctx->rx_frame_cnt;
+
+#if SECUART_BULK
+	// Длинный фрейм: тип - в слот, как у обычного, данные остаются в буфере
+	slot->bulk = NULL;
+	if (SECUART_FRAME_IS_EXT(frame)) {
+		frame[SECUART_HEADER_SIZE_EXT] = payload[0];
+		slot->bulk = ctx->rx_bulk_cur;
+		slot->bulk_len = data_size;
+		ctx->rx_bulk_cur = NULL;
+	}
+#endif
+
+	// Подлинный CNT - новая опора для коротких заголовков
+	if (!ctx->rx_cnt_ref_valid || ctx->rx_frame_cnt > ctx->rx_cnt_ref) {
+		ctx->rx_cnt_ref = ctx->rx_frame_cnt;
+		ctx->rx_cnt_ref_valid = true;
+	}
+
+	// Публикуем фрейм: с этого момента слот принадлежит основному циклу
+	__DMB();
+	ctx->rx_q_head++;
+	ctx->rx_complete = true;
+}
+
+/**
+ * @brief Повторный поиск SOF с байта, следующего за отброшенным SOF
+ */
+static void SecUart_ResyncRx(SecUartContext *ctx) {
+	// Начало длинного фрейма могло быть уже перезаписано DMA - тогда поиск
+	// продолжается с его конца
+	if (ctx->rx_head - (ctx->rx_frame_start + 1) <= SECUART_RX_RING_SIZE) {
+		ctx->rx_tail = ctx->rx_frame_start + 1;
+	}
+	ctx->rx_state = SECUART_RX_HUNT_SOF;
+	ctx->rx_frame_pos = 0;
+	ctx->rx_resyncs++;
+}
+
+/**
+ * @brief Стартовый байт фрейма
+ * @note Фреймы v1 и короткие заголовки принимаются всегда, независимо от
+ *       SECUART_TX_FRAME_V2 и SECUART_SHORT_CNT
+ */
+static bool SecUart_IsSof(uint8_t byte) {
+	return byte == SECUART_START_BYTE || byte == SECUART_START_BYTE_V2 ||
+			byte == SECUART_START_BYTE_S8 || byte == SECUART_START_BYTE_S16;
+}
+
+/**
+ * @brief CNT фрейма: в v2 - одна загрузка выровненного слова и REV
+ */
+static uint32_t SecUart_FrameCounter(const uint8_t *frame) {
+	if (SECUART_FRAME_IS_V2(frame)) {
+		uint32_t cnt_be;
+		memcpy(&cnt_be, __builtin_assume_aligned(frame + 4, 4), sizeof(cnt_be));
+		return __REV(cnt_be);
+	}
+
+	return ((uint32_t)frame[1] << 24) |
+			((uint32_t)frame[2] << 16) |
+			((uint32_t)frame[3] << 8) |
+			frame[4];
+}
+
+/**
+ * @brief Полный CNT короткого заголовка по опорному CNT приема
+ * @note Как индекс пакета в SRTP: из всех CNT с такими младшими битами
+ *       берется ближайший к rx_cnt_ref. Ошибка восстановления не опасна -
+ *       MAC не сойдется. Передатчик шлет полный CNT каждые SECUART_SHORT_SYNC
+ *       фреймов, поэтому CNT дальше 2 * SECUART_SHORT_SYNC впереди опоры или
+ *       старше окна защиты от повтора не ждем - это ложный SOF
+ * @return false, если опоры еще нет или CNT вне ожидаемого диапазона
+ */
+static bool SecUart_ExpandCounter(const SecUartContext *ctx, const uint8_t *frame, uint32_t *counter) {
+	uint32_t ref = ctx->rx_cnt_ref;
+	int32_t delta;
+
+	if (!ctx->rx_cnt_ref_valid) {
+		return false;
+	}
+
+	if (frame[0] == SECUART_START_BYTE_S8) {
+		delta = (int8_t)(uint8_t)(frame[1] - (uint8_t)ref);
+	} else {
+		uint16_t low = (uint16_t)((frame[1] << 8) | frame[2]);
+		delta = (int16_t)(uint16_t)(low - (uint16_t)ref);
+	}
+
+	*counter = ref + delta;
+	return delta > -SECUART_REPLAY_WINDOW && delta <= 2 * SECUART_SHORT_SYNC;
+}
+
+/**
+ * @brief Заголовок фрейма в MAC
+ * @note Короткий заголовок входит в MAC развернутым (SOF, все 32 бита CNT,
+ *       LEN), поэтому MAC защищает полный CNT, как и в фрейме v1
+ */
+static void SecUart_MacHeader(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *frame, uint32_t counter, uint32_t dir) {
+	// Роль передатчика не передается, но входит в MAC: фрейм узла с той же
+	// ролью иначе прошел бы проверку и расшифровался чужой гаммой
+	uint8_t role = (dir & SECUART_CTR_DIR_BIT) ? 1 : 0;
+
+	if (SECUART_FRAME_IS_SHORT(frame)) {
+		uint8_t full[SECUART_HEADER_SIZE];
+
+		full[0] = frame[0];                       // SOF короткого фрейма
+		full[1] = (counter >> 24) & 0xFF;         // CNT (MSB)
+		full[2] = (counter >> 16) & 0xFF;
+		full[3] = (counter >> 8) & 0xFF;
+		full[4] = counter & 0xFF;                 // CNT (LSB)
+		full[5] = SECUART_FRAME_LEN(frame);       // LEN
+		SecUart_MacUpdate(ctx, mac_ctx, full, sizeof(full));
+	} else {
+		SecUart_MacUpdate(ctx, mac_ctx, frame, SECUART_FRAME_HDR(frame));
+	}
+	SecUart_MacUpdate(ctx, mac_ctx, &role, 1);
+}
+
+/**
+ * @brief Проверка CNT по окну защиты от повтора
+ */
+bool SecUart_ReplayCheck(const SecUartContext *ctx, uint32_t counter) {
+	if (!ctx->rx_counter_valid || counter > ctx->rx_counter) {
+		return true;
+	}
+
+	if (ctx->rx_counter - counter >= SECUART_REPLAY_WINDOW) {
+		return false;
+	}
+
+	return (ctx->rx_replay[(counter >> 5) & SECUART_REPLAY_MASK] & (1u << (counter & 31))) == 0;
+}
+
+/**
+ * @brief Отметка CNT принятого фрейма в окне защиты от повтора
+ * @note Окно сдвигается словами: слова между старым и новым старшим CNT
+ *       обнуляются, их не больше SECUART_REPLAY_WORDS при любом скачке.
+ *       CNT старше окна не отмечается
+ */
+void SecUart_ReplayUpdate(SecUartContext *ctx, uint32_t counter) {
+	if (!ctx->rx_counter_valid) {
+		memset(ctx->rx_replay, 0, sizeof(ctx->rx_replay));
+		ctx->rx_counter = counter;
+		ctx->rx_counter_valid = true;
+	} else if (counter > ctx->rx_counter) {
+		uint32_t top = ctx->rx_counter >> 5;
+		uint32_t words = (counter >> 5) - top;
+
+		if (words > SECUART_REPLAY_WORDS) {
+			words = SECUART_REPLAY_WORDS;
+		}
+		for (uint32_t i = 1; i <= words; i++) {
+			ctx->rx_replay[(top + i) & SECUART_REPLAY_MASK] = 0;
+		}
+		ctx->rx_counter = counter;
+	} else if (ctx->rx_counter - counter >= SECUART_REPLAY_WINDOW) {
+		// CNT старше окна (повтор ARQ идет со старым CNT): его слово в кольце
+		// уже занято новыми CNT, отметка легла бы на чужой бит
+		return;
+	}
+
+	ctx->rx_replay[(counter >> 5) & SECUART_REPLAY_MASK] |= 1u << (counter & 31);
+}
+
+/**
+ * @brief Обработчик событий приема (IDLE, половина и конец кольца DMA)
+ */
+void SecUart_RxEventCallback(SecUartContext *ctx, UART_HandleTypeDef *huart) {
+	if (ctx == NULL || huart != ctx->huart_rx) {
+		return;
+	}
+
+	// Текущая позиция записи DMA в кольце. Между событиями HT/TC проходит
+	// не больше половины кольца, поэтому разность однозначна.
+	uint16_t pos = (SECUART_RX_RING_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx)) & SECUART_RX_RING_MASK;
+	uint16_t delta = (pos - ctx->rx_dma_pos) & SECUART_RX_RING_MASK;
+
+	if (delta == 0) {
+		return;
+	}
+
+	ctx->rx_dma_pos = pos;
+	ctx->rx_head += delta;
+
+	// Пропускаем новые блоки через MAC и расшифрование, пока DMA принимает дальше
+	if (!ctx->rx_stalled) {
+		SecUart_RxPump(ctx);
+	}
+}
+
+/**
+ * @brief Обработчик завершения передачи по DMA
+ */
+void SecUart_TxCpltCallback(SecUartContext *ctx, UART_HandleTypeDef *huart) {
+	if (ctx == NULL || huart != ctx->huart_tx) {
+		return;
+	}
+
+	// Фрейм ушел - освобождаем слот и сразу запускаем следующий
+	SecUart_TxSlotDone(ctx);
+	SecUart_StartNextTx(ctx);
+}
+
+/**
+ * @brief Освобождение слота ушедшего (или сброшенного) фрейма
+ */
+static void SecUart_TxSlotDone(SecUartContext *ctx) {
+#if SECUART_BULK
+	SecUartTxSlot *slot = &ctx->tx_queue[ctx->tx_q_tail & SECUART_TX_QUEUE_MASK];
+
+	if (slot->ext != NULL) {
+		slot->ext = NULL;
+		ctx->tx_bulk_busy = false;
+	}
+#endif
+	ctx->tx_q_tail++;
+	ctx->tx_complete = true;
+}
+
+/**
+ * @brief Обработчик ошибок UART
+ */
+void SecUart_ErrorCallback(SecUartContext *ctx, UART_HandleTypeDef *huart) {
+	if (ctx == NULL) {
+		return;
+	}
+
+	// При ошибке (ORE/FE/NE) HAL останавливает DMA прием - запускаем его заново
+	if (huart == ctx->huart_rx && huart->RxState == HAL_UART_STATE_READY) {
+		ctx->errors_detected++;
+		SecUart_StartReceive(ctx);
+	}
+
+	// Ошибка DMA передачи: TxCplt уже не придет, отбрасываем текущий фрейм
+	if (huart == ctx->huart_tx && !ctx->tx_complete && huart->gState == HAL_UART_STATE_READY) {
+		ctx->errors_detected++;
+		SecUart_TxSlotDone(ctx);
+		SecUart_StartNextTx(ctx);
+	}
+}
+
+/**
+ * @brief Предварительный расчет гаммы для следующих фреймов в простое
+ */
+uint16_t SecUart_PrecomputeKeystream(SecUartContext *ctx, uint16_t max_blocks) {
+	uint16_t done;
+
+	// Набору без шифрования гамма не нужна
+	if (SECUART_SUITE(ctx)->encrypt == NULL) {
+		return 0;
+	}
+
+	// Передача идет из основного цикла, поэтому пул TX заполняем без блокировок
+	done = SecUart_FillKeystream(ctx->cipher_ctx, ctx->tx_ks, ctx->tx_dir, ctx->tx_counter, max_blocks);
+
+	// Пул RX читается из прерывания, запись защищена порядком blocks_ready/counter
+	done += SecUart_FillKeystream(ctx->cipher_ctx, ctx->rx_ks, ctx->rx_dir, ctx->rx_counter, max_blocks - done);
+
+	return done;
+}
 
 /**
- * @brief Вычисление MAC для данных
+ * @brief Отправка отладочного сообщения через монитор
+ */
+void SecUart_Log(SecUartContext *ctx, const char *msg) {
+	if (ctx == NULL || ctx->huart_monitor == NULL || msg == NULL) {
+		return;
+	}
+
+	HAL_UART_Transmit(ctx->huart_monitor, (uint8_t*)msg, strlen(msg), 100);
+}
+
+/**
+ * @brief Блок гаммы CTR: Speck(CNT || DIR | номер блока)
  */
-static void SecUart_CalculateMAC(const SpeckContext *ctx, const uint8_t *data, uint8_t size, uint8_t *mac) {
-	speck_mac(ctx, data, size, mac);
+static void SecUart_KeystreamBlock(const SpeckContext *ctx, uint32_t counter, uint32_t index, uint8_t *out) {
+	uint32_t block[2] = { counter, index };
+
+	speck_encrypt(ctx, block);
+
+	// Слова в порядке big-endian: REV и запись словом вместо разбора на байты
+	block[0] = __REV(block[0]);
+	block[1] = __REV(block[1]);
+	memcpy(out, block, SECUART_BLOCK_SIZE);
 }
 
 /**
- * @brief Проверка MAC для данных
+ * @brief Шифрование/расшифрование данных в режиме CTR (одна и та же операция)
+ * @param pool Пул гаммы направления; блоки, которых в нем нет, считаются на месте
+ * @param dir Бит направления передатчика фрейма (SECUART_CTR_DIR_BIT или 0)
+ * @param counter CNT фрейма
+ * @param offset Смещение data от начала данных фрейма (кратно размеру блока)
+ * @note Один ключ не должен использоваться двумя передатчиками с общими CNT
+ *       и одинаковым dir
+ */
+static void SecUart_CtrXor(const SpeckContext *ctx, const SecUartKeystream *pool, uint32_t dir, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size) {
+	const SecUartKeystream *ks = &pool[counter & SECUART_KS_POOL_MASK];
+	uint32_t local[SECUART_BLOCK_SIZE / 4];
+
+	for (uint16_t i = 0; i < size; i += SECUART_BLOCK_SIZE) {
+		uint16_t index = (offset + i) / SECUART_BLOCK_SIZE;
+		uint16_t n = (size - i < SECUART_BLOCK_SIZE) ? size - i : SECUART_BLOCK_SIZE;
+		const uint8_t *gamma;
+
+		// Блок из пула годится, только если он посчитан для этого же CNT
+		if (ks->counter == counter && index < ks->blocks_ready) {
+			gamma = &ks->stream[index * SECUART_BLOCK_SIZE];
+		} else {
+			SecUart_KeystreamBlock(ctx, counter, dir | index, (uint8_t *)local);
+			gamma = (const uint8_t *)local;
+		}
+
+		SecUart_XorBlock(data + i, gamma, n);
+	}
+}
+
+/**
+ * @brief XOR n байт данных (1..8) с блоком гаммы
+ * @note Блок данных фрейма v2 выровнен, как и гамма: два слова за раз, а
+ *       неполный последний блок маскируется без ветвлений по n. Байты за
+ *       концом данных (начало MAC) перезаписываются тем же значением.
+ *       Данные фрейма v1 идут со смещения 6 - побайтно.
+ */
+static void SecUart_XorBlock(uint8_t *data, const uint8_t *gamma, uint16_t n) {
+	if (((uintptr_t)data & 3) == 0) {
+		uint32_t d[2];
+		uint32_t g[2];
+		uint64_t mask = UINT64_MAX >> (8 * (SECUART_BLOCK_SIZE - n));
+
+		memcpy(d, __builtin_assume_aligned(data, 4), sizeof(d));
+		memcpy(g, __builtin_assume_aligned(gamma, 4), sizeof(g));
+		d[0] ^= g[0] & (uint32_t)mask;
+		d[1] ^= g[1] & (uint32_t)(mask >> 32);
+		memcpy(__builtin_assume_aligned(data, 4), d, sizeof(d));
+		return;
+	}
+
+	for (uint16_t k = 0; k < n; k++) {
+		data[k] ^= gamma[k];
+	}
+}
+
+/**
+ * @brief Дозаполнение пула гаммы для следующих CNT одного направления
+ * @param dir Бит направления (ctx->tx_dir или ctx->rx_dir)
+ * @return Количество посчитанных блоков
+ */
+static uint16_t SecUart_FillKeystream(const SpeckContext *ctx, SecUartKeystream *pool, uint32_t dir, uint32_t base, uint16_t max_blocks) {
+	uint16_t done = 0;
+
+	for (uint32_t k = 1; k <= SECUART_KS_POOL_LEN && done < max_blocks; k++) {
+		uint32_t counter = base + k;
+		SecUartKeystream *ks = &pool[counter & SECUART_KS_POOL_MASK];
+
+		// Перепривязка записи: сначала обнуляем готовность, затем меняем CNT,
+		// чтобы прерывание приема не взяло старую гамму для нового счетчика
+		if (ks->counter != counter) {
+			ks->blocks_ready = 0;
+			__DMB();
+			ks->counter = counter;
+			__DMB();
+		}
+
+		while (ks->blocks_ready < SECUART_KS_BLOCKS && done < max_blocks) {
+			SecUart_KeystreamBlock(ctx, counter, dir | ks->blocks_ready,
+					&ks->stream[ks->blocks_ready * SECUART_BLOCK_SIZE]);
+			__DMB();
+			ks->blocks_ready++;
+			done++;
+		}
+	}
+
+	return done;
+}
+
+/**
+ * @brief Шифрование (tx) или расшифрование данных фрейма набором канала
+ */
+static void SecUart_PayloadCrypt(const SecUartContext *ctx, bool tx, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size) {
+	const SecUartSuite *suite = SECUART_SUITE(ctx);
+
+	if (tx && suite->encrypt != NULL) {
+		suite->encrypt(ctx, counter, offset, data, size);
+	} else if (!tx && suite->decrypt != NULL) {
+		suite->decrypt(ctx, counter, offset, data, size);
+	}
+}
+
+/**
+ * @brief Начало потокового MAC фрейма
+ */
+static void SecUart_MacInit(const SecUartContext *ctx, SecUartMac *mac_ctx) {
+	SECUART_SUITE(ctx)->mac_init(ctx, mac_ctx);
+}
+
+/**
+ * @brief Добавление данных в MAC фрейма
+ */
+static void SecUart_MacUpdate(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *data, uint16_t len) {
+	SECUART_SUITE(ctx)->mac_update(ctx, mac_ctx, data, len);
+}
+
+/**
+ * @brief Завершение MAC фрейма
+ * @param mac Буфер тега (tag_size набора)
+ */
+static void SecUart_MacFinal(const SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *mac) {
+	SECUART_SUITE(ctx)->mac_final(ctx, mac_ctx, mac);
+}
+
+#if SECUART_SUITE_SIPHASH || SECUART_SUITE_HALFSIPHASH
+/**
+ * @brief Вывод ключа MAC из ключа шифрования: Speck(MACK || FFFFFFFE..FFFFFFFF)
+ * @note Номер блока CTR (без бита DIR) не доходит до 0x7FFFFFFE, поэтому эти
+ *       блоки никогда не попадают в гамму и ключ MAC не виден в шифротексте
+ */
+static void SecUart_DeriveMacKey(SecUartContext *ctx) {
+	SecUart_KeystreamBlock(ctx->cipher_ctx, 0x4D41434B, 0xFFFFFFFE, ctx->mac_key);
+	SecUart_KeystreamBlock(ctx->cipher_ctx, 0x4D41434B, 0xFFFFFFFF, ctx->mac_key + SECUART_BLOCK_SIZE);
+}
+#endif
+
+#if SECUART_SUITE_SPECK || SECUART_SUITE_SIPHASH || SECUART_SUITE_HALFSIPHASH
+/**
+ * @brief Speck-CTR: шифрование с гаммой из пула передачи
+ */
+static void SecUart_SpeckEncrypt(const SecUartContext *ctx, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size) {
+	SecUart_CtrXor(ctx->cipher_ctx, ctx->tx_ks, ctx->tx_dir, counter, offset, data, size);
+}
+
+/**
+ * @brief Speck-CTR: расшифрование с гаммой из пула приема
+ */
+static void SecUart_SpeckDecrypt(const SecUartContext *ctx, uint32_t counter, uint16_t offset, uint8_t *data, uint16_t size) {
+	SecUart_CtrXor(ctx->cipher_ctx, ctx->rx_ks, ctx->rx_dir, counter, offset, data, size);
+}
+#endif
+
+#if SECUART_SUITE_SPECK
+static void SecUart_SpeckMacInit(const SecUartContext *ctx, SecUartMac *mac_ctx) {
+	(void)ctx;
+	speck_mac_init(&mac_ctx->state.speck);
+}
+
+static void SecUart_SpeckMacUpdate(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *data, uint16_t len) {
+	speck_mac_update(ctx->cipher_ctx, &mac_ctx->state.speck, data, len);
+}
+
+static void SecUart_SpeckMacFinal(const SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *tag) {
+	speck_mac_final(ctx->cipher_ctx, &mac_ctx->state.speck, tag);
+}
+
+const SecUartSuite SecUart_SuiteSpeck = {
+	.name = "Speck64/128-CTR + CBC-MAC",
+	.block_size = SECUART_BLOCK_SIZE,
+	.tag_size = SECUART_MAC_SIZE,
+	.encrypt = SecUart_SpeckEncrypt,
+	.decrypt = SecUart_SpeckDecrypt,
+	.mac_init = SecUart_SpeckMacInit,
+	.mac_update = SecUart_SpeckMacUpdate,
+	.mac_final = SecUart_SpeckMacFinal,
+};
+#endif
+
+#if SECUART_SUITE_SIPHASH
+static void SecUart_SipMacInit(const SecUartContext *ctx, SecUartMac *mac_ctx) {
+	SipHash_Init(&mac_ctx->state.sip, ctx->mac_key, SIPHASH13_CROUND, SIPHASH13_FROUND);
+}
+
+static void SecUart_SipMacUpdate(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *data, uint16_t len) {
+	(void)ctx;
+	SipHash_Update(&mac_ctx->state.sip, data, len);
+}
+
+static void SecUart_SipMacFinal(const SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *tag) {
+	(void)ctx;
+	SipHash_Final(&mac_ctx->state.sip, tag);
+}
+
+const SecUartSuite SecUart_SuiteSipHash = {
+	.name = "Speck64/128-CTR + SipHash-1-3",
+	.block_size = SECUART_BLOCK_SIZE,
+	.tag_size = SECUART_MAC_SIZE,
+	.encrypt = SecUart_SpeckEncrypt,
+	.decrypt = SecUart_SpeckDecrypt,
+	.mac_init = SecUart_SipMacInit,
+	.mac_update = SecUart_SipMacUpdate,
+	.mac_final = SecUart_SipMacFinal,
+};
+#endif
+
+#if SECUART_SUITE_HALFSIPHASH
+static void SecUart_HalfSipMacInit(const SecUartContext *ctx, SecUartMac *mac_ctx) {
+	HalfSipHash_Init(&mac_ctx->state.half, ctx->mac_key);
+}
+
+static void SecUart_HalfSipMacUpdate(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *data, uint16_t len) {
+	(void)ctx;
+	HalfSipHash_Update(&mac_ctx->state.half, data, len);
+}
+
+static void SecUart_HalfSipMacFinal(const SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *tag) {
+	(void)ctx;
+	HalfSipHash_Final(&mac_ctx->state.half, tag);
+}
+
+const SecUartSuite SecUart_SuiteHalfSipHash = {
+	.name = "Speck64/128-CTR + HalfSipHash-2-4",
+	.block_size = SECUART_BLOCK_SIZE,
+	.tag_size = SECUART_MAC_SIZE,
+	.encrypt = SecUart_SpeckEncrypt,
+	.decrypt = SecUart_SpeckDecrypt,
+	.mac_init = SecUart_HalfSipMacInit,
+	.mac_update = SecUart_HalfSipMacUpdate,
+	.mac_final = SecUart_HalfSipMacFinal,
+};
+#endif
+
+#if SECUART_SUITE_CRC
+static void SecUart_CrcInit(const SecUartContext *ctx, SecUartMac *mac_ctx) {
+	(void)ctx;
+	mac_ctx->state.crc = 0xFFFF;
+}
+
+/**
+ * @brief CRC-16/MODBUS, как в варианте протокола без шифрования
+ * @note Считается общим движком по таблицам (crc_engine), а не побитно
+ */
+static void SecUart_CrcUpdate(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *data, uint16_t len) {
+	(void)ctx;
+	mac_ctx->state.crc = Crc16_SlicedUpdate(mac_ctx->state.crc, data, len);
+}
+
+static void SecUart_CrcFinal(const SecUartContext *ctx, SecUartMac *mac_ctx, uint8_t *tag) {
+	(void)ctx;
+	tag[0] = mac_ctx->state.crc & 0xFF;           // CRC (LSB)
+	tag[1] = (mac_ctx->state.crc >> 8) & 0xFF;    // CRC (MSB)
+}
+
+const SecUartSuite SecUart_SuiteCrc = {
+	.name = "CRC-16 only (no encryption)",
+	.block_size = SECUART_BLOCK_SIZE,
+	.tag_size = 2,
+	.encrypt = NULL,
+	.decrypt = NULL,
+	.mac_init = SecUart_CrcInit,
+	.mac_update = SecUart_CrcUpdate,
+	.mac_final = SecUart_CrcFinal,
+};
+#endif
+
+/**
+ * @brief Проверка MAC, накопленного потоково
  */
-static bool SecUart_VerifyMAC(const SpeckContext *ctx, const uint8_t *data, uint8_t size, const uint8_t *mac) {
+static bool SecUart_VerifyMAC(const SecUartContext *ctx, SecUartMac *mac_ctx, const uint8_t *mac) {
 	uint8_t calculated_mac[SECUART_MAC_SIZE];
 
-	// Вычисляем MAC
-	SecUart_CalculateMAC(ctx, data, size, calculated_mac);
+	// Завершаем MAC
+	SecUart_MacFinal(ctx, mac_ctx, calculated_mac);
 
 	// Сравниваем MAC
-	return (memcmp(calculated_mac, mac, SECUART_MAC_SIZE) == 0);
+	return (memcmp(calculated_mac, mac, SECUART_SUITE(ctx)->tag_size) == 0);
 }
@@ -1,6 +1,5 @@
 #include "speck.h"
 #include <string.h>
-#include <stdlib.h>
 
 /**
  * @brief Циклический сдвиг вправо для 32-битного слова
@@ -49,7 +48,12 @@ void speck_init(SpeckContext *ctx, const uint32_t *key) {
     }
 }
 
-void speck_encrypt(const SpeckContext *ctx, uint32_t *block) {
+/**
+ * @brief Шифрование блока компактным циклом раундов
+ * @note Им же считается CBC-MAC и при SPECK_UNROLLED: развернутые раунды
+ *       касаются только speck_encrypt/speck_decrypt
+ */
+static void speck_encrypt_loop(const SpeckContext *ctx, uint32_t *block) {
     // Параметры алгоритма Speck (согласно спецификации)
     const uint32_t alpha = 8; // Параметр сдвига
     const uint32_t beta = 3;  // Параметр сдвига
@@ -68,6 +72,107 @@ void speck_encrypt(const SpeckContext *ctx, uint32_t *block) {
     block[1] = y;
 }
 
+#if SPECK_UNROLLED
+
+// Сдвиги записаны выражениями, чтобы компилятор свернул их в операнд
+// ADD/EOR с ROR (barrel shifter Cortex-M4), а не вызывал ror32/rol32
+#define SPECK_ROR(v, n) (((v) >> (n)) | ((v) << (32 - (n))))
+#define SPECK_ROL(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+// Раунд Speck64/128 (alpha = 8, beta = 3)
+#define SPECK_ROUND(x, y, k) do { \
+        (x) = (SPECK_ROR(x, 8) + (y)) ^ (k); \
+        (y) = SPECK_ROL(y, 3) ^ (x); \
+    } while (0)
+
+// Обратный раунд
+#define SPECK_INV_ROUND(x, y, k) do { \
+        (y) = SPECK_ROR((y) ^ (x), 3); \
+        (x) = SPECK_ROL(((x) ^ (k)) - (y), 8); \
+    } while (0)
+
+void speck_encrypt(const SpeckContext *ctx, uint32_t *block) {
+    const uint32_t *rk = ctx->round_keys;
+    uint32_t x = block[0];
+    uint32_t y = block[1];
+
+    // 27 раундов без цикла: x/y остаются в регистрах
+    SPECK_ROUND(x, y, rk[0]);
+    SPECK_ROUND(x, y, rk[1]);
+    SPECK_ROUND(x, y, rk[2]);
+    SPECK_ROUND(x, y, rk[3]);
+    SPECK_ROUND(x, y, rk[4]);
+    SPECK_ROUND(x, y, rk[5]);
+    SPECK_ROUND(x, y, rk[6]);
+    SPECK_ROUND(x, y, rk[7]);
+    SPECK_ROUND(x, y, rk[8]);
+    SPECK_ROUND(x, y, rk[9]);
+    SPECK_ROUND(x, y, rk[10]);
+    SPECK_ROUND(x, y, rk[11]);
+    SPECK_ROUND(x, y, rk[12]);
+    SPECK_ROUND(x, y, rk[13]);
+    SPECK_ROUND(x, y, rk[14]);
+    SPECK_ROUND(x, y, rk[15]);
+    SPECK_ROUND(x, y, rk[16]);
+    SPECK_ROUND(x, y, rk[17]);
+    SPECK_ROUND(x, y, rk[18]);
+    SPECK_ROUND(x, y, rk[19]);
+    SPECK_ROUND(x, y, rk[20]);
+    SPECK_ROUND(x, y, rk[21]);
+    SPECK_ROUND(x, y, rk[22]);
+    SPECK_ROUND(x, y, rk[23]);
+    SPECK_ROUND(x, y, rk[24]);
+    SPECK_ROUND(x, y, rk[25]);
+    SPECK_ROUND(x, y, rk[26]);
+
+    block[0] = x;
+    block[1] = y;
+}
+
+void speck_decrypt(const SpeckContext *ctx, uint32_t *block) {
+    const uint32_t *rk = ctx->round_keys;
+    uint32_t x = block[0];
+    uint32_t y = block[1];
+
+    // 27 раундов расшифрования в обратном порядке ключей
+    SPECK_INV_ROUND(x, y, rk[26]);
+    SPECK_INV_ROUND(x, y, rk[25]);
+    SPECK_INV_ROUND(x, y, rk[24]);
+    SPECK_INV_ROUND(x, y, rk[23]);
+    SPECK_INV_ROUND(x, y, rk[22]);
+    SPECK_INV_ROUND(x, y, rk[21]);
+    SPECK_INV_ROUND(x, y, rk[20]);
+    SPECK_INV_ROUND(x, y, rk[19]);
+    SPECK_INV_ROUND(x, y, rk[18]);
+    SPECK_INV_ROUND(x, y, rk[17]);
+    SPECK_INV_ROUND(x, y, rk[16]);
+    SPECK_INV_ROUND(x, y, rk[15]);
+    SPECK_INV_ROUND(x, y, rk[14]);
+    SPECK_INV_ROUND(x, y, rk[13]);
+    SPECK_INV_ROUND(x, y, rk[12]);
+    SPECK_INV_ROUND(x, y, rk[11]);
+    SPECK_INV_ROUND(x, y, rk[10]);
+    SPECK_INV_ROUND(x, y, rk[9]);
+    SPECK_INV_ROUND(x, y, rk[8]);
+    SPECK_INV_ROUND(x, y, rk[7]);
+    SPECK_INV_ROUND(x, y, rk[6]);
+    SPECK_INV_ROUND(x, y, rk[5]);
+    SPECK_INV_ROUND(x, y, rk[4]);
+    SPECK_INV_ROUND(x, y, rk[3]);
+    SPECK_INV_ROUND(x, y, rk[2]);
+    SPECK_INV_ROUND(x, y, rk[1]);
+    SPECK_INV_ROUND(x, y, rk[0]);
+
+    block[0] = x;
+    block[1] = y;
+}
+
+#else
+
+void speck_encrypt(const SpeckContext *ctx, uint32_t *block) {
+    speck_encrypt_loop(ctx, block);
+}
+
 void speck_decrypt(const SpeckContext *ctx, uint32_t *block) {
     // Параметры алгоритма Speck (согласно спецификации)
     const uint32_t alpha = 8; // Параметр сдвига
@@ -90,52 +195,102 @@ void speck_decrypt(const SpeckContext *ctx, uint32_t *block) {
     block[1] = y;
 }
 
-void speck_mac(const SpeckContext *ctx, const uint8_t *data, size_t len, uint8_t *mac) {
-    uint32_t mac_block[2] = {0, 0}; // Инициализационный вектор - нули
-    uint32_t block[2];
-    uint8_t *padded_data;
-    size_t padded_len;
-
-    // Дополняем данные до кратности 8 байт (64 бит)
-    padded_len = ((len + 7) / 8) * 8;
-    padded_data = (uint8_t*)calloc(padded_len, 1);
-    if (padded_data == NULL) {
-        return; // Ошибка выделения памяти
+#endif // SPECK_UNROLLED
+
+/**
+ * @brief Один шаг CBC-MAC: XOR блока (big-endian) с цепочкой и шифрование
+ * @param ctx Указатель на инициализированный контекст
+ * @param state Цепочка CBC
+ * @param block Указатель на 8 байт данных
+ */
+static inline void speck_mac_block(const SpeckContext *ctx, uint32_t *state, const uint8_t *block) {
+#if defined(__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // Слово целиком (LDR, на M4 допустим и невыровненный) и REV
+    uint32_t w[2];
+    memcpy(w, block, sizeof(w));
+    state[0] ^= __builtin_bswap32(w[0]);
+    state[1] ^= __builtin_bswap32(w[1]);
+#else
+    state[0] ^= ((uint32_t)block[0] << 24) |
+                ((uint32_t)block[1] << 16) |
+                ((uint32_t)block[2] << 8) |
+                block[3];
+    state[1] ^= ((uint32_t)block[4] << 24) |
+                ((uint32_t)block[5] << 16) |
+                ((uint32_t)block[6] << 8) |
+                block[7];
+#endif
+
+    speck_encrypt_loop(ctx, state);
+}
+
+void speck_mac_blocks(const SpeckContext *ctx, uint32_t *state, const uint8_t *data, size_t nblocks) {
+    while (nblocks-- > 0) {
+        speck_mac_block(ctx, state, data);
+        data += 8;
     }
+}
+
+void speck_mac_init(SpeckMacContext *mac_ctx) {
+    // Инициализационный вектор - нули
+    mac_ctx->state[0] = 0;
+    mac_ctx->state[1] = 0;
+    mac_ctx->buffer_len = 0;
+}
 
-    // Копируем исходные данные в дополненный буфер
-    memcpy(padded_data, data, len);
+void speck_mac_update(const SpeckContext *ctx, SpeckMacContext *mac_ctx, const uint8_t *data, size_t len) {
+    // Дополняем ранее накопленный неполный блок
+    if (mac_ctx->buffer_len > 0) {
+        size_t take = 8 - mac_ctx->buffer_len;
+        if (take > len) {
+            take = len;
+        }
 
-    // Обрабатываем данные блоками по 8 байт (64 бит) - CBC-MAC на основе Speck
-    for (size_t i = 0; i < padded_len; i += 8) {
-        // Преобразуем 8 байт в два 32-битных слова (big-endian)
-        block[0] = ((uint32_t)padded_data[i] << 24) |
-                  ((uint32_t)padded_data[i+1] << 16) |
-                  ((uint32_t)padded_data[i+2] << 8) |
-                  padded_data[i+3];
+        memcpy(mac_ctx->buffer + mac_ctx->buffer_len, data, take);
+        mac_ctx->buffer_len += take;
+        data += take;
+        len -= take;
 
-        block[1] = ((uint32_t)padded_data[i+4] << 24) |
-                  ((uint32_t)padded_data[i+5] << 16) |
-                  ((uint32_t)padded_data[i+6] << 8) |
-                  padded_data[i+7];
+        if (mac_ctx->buffer_len < 8) {
+            return;
+        }
 
-        // XOR с предыдущим результатом (для CBC режима)
-        block[0] ^= mac_block[0];
-        block[1] ^= mac_block[1];
+        speck_mac_block(ctx, mac_ctx->state, mac_ctx->buffer);
+        mac_ctx->buffer_len = 0;
+    }
 
-        // Шифруем блок
-        speck_encrypt(ctx, block);
+    // Полные блоки обрабатываем прямо из входных данных, без копирования
+    speck_mac_blocks(ctx, mac_ctx->state, data, len / 8);
+    data += len & ~(size_t)7;
+    len &= 7;
 
-        // Сохраняем результат для следующей итерации
-        mac_block[0] = block[0];
-        mac_block[1] = block[1];
+    // Остаток сохраняем до следующего вызова
+    if (len > 0) {
+        memcpy(mac_ctx->buffer, data, len);
+        mac_ctx->buffer_len = len;
     }
+}
 
-    free(padded_data);
+void speck_mac_final(const SpeckContext *ctx, SpeckMacContext *mac_ctx, uint8_t *mac) {
+    // Дополняем последний блок нулями до кратности 8 байт (64 бит)
+    if (mac_ctx->buffer_len > 0) {
+        memset(mac_ctx->buffer + mac_ctx->buffer_len, 0, 8 - mac_ctx->buffer_len);
+        speck_mac_block(ctx, mac_ctx->state, mac_ctx->buffer);
+        mac_ctx->buffer_len = 0;
+    }
 
     // Преобразуем 64-битный MAC (2 слова по 32 бита) в 8 байт
     for (int i = 0; i < 4; i++) {
-        mac[i] = (mac_block[0] >> (24 - i*8)) & 0xFF;
-        mac[i+4] = (mac_block[1] >> (24 - i*8)) & 0xFF;
+        mac[i] = (mac_ctx->state[0] >> (24 - i*8)) & 0xFF;
+        mac[i+4] = (mac_ctx->state[1] >> (24 - i*8)) & 0xFF;
     }
 }
+
+void speck_mac(const SpeckContext *ctx, const uint8_t *data, size_t len, uint8_t *mac) {
+    // CBC-MAC на основе Speck без промежуточного буфера и кучи
+    SpeckMacContext mac_ctx;
+
+    speck_mac_init(&mac_ctx);
+    speck_mac_update(ctx, &mac_ctx, data, len);
+    speck_mac_final(ctx, &mac_ctx, mac);
+}
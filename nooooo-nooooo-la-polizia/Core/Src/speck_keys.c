@@ -0,0 +1,31 @@
+/**
+ * @file speck_keys.c
+ * @brief Раундовые ключи Speck64/128, развернутые при сборке
+ * @note Сгенерировано Tools/speck_keygen, не редактировать вручную
+ */
+
+#include "speck_keys.h"
+
+// Ключ 0x0F0E0D0C 0x0B0A0908 0x07060504 0x03020100
+const SpeckContext secure_key_ctx = {
+	.round_keys = {
+		0x0F0E0D0C, 0x6F697F75, 0x083B7ED0, 0x49E57653,
+		0x11D73DF3, 0x03F341E4, 0xC9618F41, 0x79CCF1D8,
+		0x383DB242, 0x5BF93FDB, 0xEDE5FEB5, 0x00F3AD54,
+		0xCC10A8AA, 0x5BC791F0, 0x890BE1C7, 0xDB8861BB,
+		0x5D80A95E, 0x4ED2AA2E, 0xA0F3D0FE, 0x26EB1345,
+		0x34D5711F, 0x67005F4D, 0x2F232E9F, 0x1C3FC865,
+		0x30FF3703, 0xA2EFE0D6, 0x282A013E,
+	}
+};
+
+// Те же ключи в порядке расшифрования: secure_key_dec[i] = round_keys[26 - i]
+const uint32_t secure_key_dec[27] = {
+	0x282A013E, 0xA2EFE0D6, 0x30FF3703, 0x1C3FC865,
+	0x2F232E9F, 0x67005F4D, 0x34D5711F, 0x26EB1345,
+	0xA0F3D0FE, 0x4ED2AA2E, 0x5D80A95E, 0xDB8861BB,
+	0x890BE1C7, 0x5BC791F0, 0xCC10A8AA, 0x00F3AD54,
+	0xEDE5FEB5, 0x5BF93FDB, 0x383DB242, 0x79CCF1D8,
+	0xC9618F41, 0x03F341E4, 0x11D73DF3, 0x49E57653,
+	0x083B7ED0, 0x6F697F75, 0x0F0E0D0C,
+};
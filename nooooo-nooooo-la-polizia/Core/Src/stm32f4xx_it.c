@@ -308,14 +308,7 @@ void DMA2_Stream7_IRQHandler(void)
 void USART6_IRQHandler(void)
 {
   /* USER CODE BEGIN USART6_IRQn 0 */
-  // Проверяем признак прерывания IDLE
-  if (__HAL_UART_GET_FLAG(&huart6, UART_FLAG_IDLE)) {
-    // Сбрасываем флаг IDLE
-    __HAL_UART_CLEAR_IDLEFLAG(&huart6);
-
-    // Вызываем обработчик IDLE-прерывания
-    HAL_UARTEx_RxEventCallback(&huart6, 0);
-  }
+  // IDLE обрабатывается в HAL_UART_IRQHandler (прием ReceiveToIdle по циклическому DMA)
   /* USER CODE END USART6_IRQn 0 */
   HAL_UART_IRQHandler(&huart6);
   /* USER CODE BEGIN USART6_IRQn 1 */
@@ -0,0 +1,27 @@
+/**
+ * @file test_data.c
+ * @brief Тестовые сообщения 8..128 байт
+ * @note Собирается и в прошивку, и в Tools/speck_bench (хост)
+ */
+
+#include "test_data.h"
+
+uint8_t test_dataXS[8] = {0xE1, 0x09, 0xCA, 0x06, 0x5D, 0xE3, 0x74, 0x83};
+
+uint8_t test_dataS[16] = {0x0C, 0x78, 0x0A, 0x2B, 0xFA, 0xAC, 0x5B, 0xB9, 0xE6, 0x0E, 0xA2, 0x83, 0xED, 0xD9, 0x69, 0x13};
+
+uint8_t test_dataM[32] = {0x59, 0x67, 0xA6, 0xE8, 0x5C, 0xFF, 0x9A, 0x88, 0x56, 0xC6, 0x24, 0x4A, 0xA1, 0x9A, 0x9C, 0xF5,
+		0x4D, 0x70, 0xA6, 0x4D, 0x50, 0xE9, 0x3A, 0x17, 0xB8, 0x1C, 0x9B, 0x57, 0xFD, 0x4B, 0xFC, 0x9C};
+
+uint8_t test_dataL[64] = {0x8B, 0xC4, 0xAC, 0x73, 0x8B, 0x9F, 0x9A, 0xAF, 0xC5, 0x9A, 0xD4, 0xA3, 0x14, 0x30, 0xA7, 0x2C,
+		0x96, 0x3F, 0xFB, 0xEE, 0x61, 0xD7, 0xCA, 0x12, 0xE1, 0x06, 0x39, 0x90, 0xD3, 0xAE, 0x40, 0xF3, 0x32, 0x53, 0xE6,
+		0xA9, 0x6E, 0xAF, 0xFF, 0x71, 0xB4, 0x91, 0x6D, 0x4F, 0xA8, 0x09, 0x16, 0xB9, 0xB7, 0x8D, 0x08, 0x08, 0x4F, 0xE5,
+		0xB8, 0xF8, 0x32, 0xA8, 0x5C, 0x75, 0x1F, 0x80, 0x0A, 0x9D};
+
+uint8_t test_dataXL[128] = {0x72, 0x07, 0xFE, 0xAF, 0x5A, 0x6B, 0x35, 0xA6, 0x4B, 0xA8, 0x03, 0xBE, 0x97, 0xEA, 0x1E, 0x09,
+		0x61, 0x4C, 0xB9, 0xDA, 0x13, 0x20, 0x96, 0xD5, 0xA6, 0x07, 0xD1, 0x07, 0xC5, 0x1D, 0xD4, 0x69, 0x8B, 0x15, 0xE3,
+		0x81, 0x6C, 0x51, 0x53, 0x6C, 0x6E, 0xAF, 0xE7, 0x22, 0xCE, 0x5F, 0x63, 0xCE, 0xBA, 0x7A, 0x78, 0xA6, 0x2B, 0x8D,
+		0x55, 0xFA, 0x68, 0x7B, 0x0F, 0xD7, 0x99, 0x6C, 0xB4, 0x20, 0x67, 0xD9, 0x7A, 0xE1, 0xEE, 0x1E, 0xE2, 0xDB, 0x38,
+		0xE6, 0xAE, 0x2D, 0x8C, 0x25, 0x2F, 0x96, 0xC4, 0x7D, 0x95, 0xEC, 0xF6, 0x94, 0x26, 0x1C, 0x8C, 0xEE, 0x03, 0xBF,
+		0xF1, 0x1C, 0x8B, 0xD4, 0x81, 0x04, 0x86, 0xC6, 0xC9, 0xEB, 0x39, 0x7E, 0x59, 0x90, 0x9D, 0x81, 0x2F, 0x64, 0xEB,
+		0x5F, 0x0F, 0xE6, 0x4B, 0x0A, 0x6C, 0x87, 0xD4, 0xB9, 0x48, 0xDC, 0xCF, 0x21, 0x51, 0x18, 0xFE, 0xDD};
@@ -5,34 +5,58 @@
 
 # Add inputs and outputs from these tool invocations to the build variables 
 C_SRCS += \
+../Core/Src/cnt_store.c \
+../Core/Src/crc_engine.c \
+../Core/Src/halfsiphash.c \
+../Core/Src/lzss.c \
+../Core/Src/mac_bench.c \
 ../Core/Src/main.c \
 ../Core/Src/secure_uart.c \
+../Core/Src/siphash.c \
 ../Core/Src/speck.c \
+../Core/Src/speck_keys.c \
 ../Core/Src/stm32f4xx_hal_msp.c \
 ../Core/Src/stm32f4xx_it.c \
 ../Core/Src/syscalls.c \
 ../Core/Src/sysmem.c \
-../Core/Src/system_stm32f4xx.c 
+../Core/Src/system_stm32f4xx.c \
+../Core/Src/test_data.c 
 
 OBJS += \
+./Core/Src/cnt_store.o \
+./Core/Src/crc_engine.o \
+./Core/Src/halfsiphash.o \
+./Core/Src/lzss.o \
+./Core/Src/mac_bench.o \
 ./Core/Src/main.o \
 ./Core/Src/secure_uart.o \
+./Core/Src/siphash.o \
 ./Core/Src/speck.o \
+./Core/Src/speck_keys.o \
 ./Core/Src/stm32f4xx_hal_msp.o \
 ./Core/Src/stm32f4xx_it.o \
 ./Core/Src/syscalls.o \
 ./Core/Src/sysmem.o \
-./Core/Src/system_stm32f4xx.o 
+./Core/Src/system_stm32f4xx.o \
+./Core/Src/test_data.o 
 
 C_DEPS += \
+./Core/Src/cnt_store.d \
+./Core/Src/crc_engine.d \
+./Core/Src/halfsiphash.d \
+./Core/Src/lzss.d \
+./Core/Src/mac_bench.d \
 ./Core/Src/main.d \
 ./Core/Src/secure_uart.d \
+./Core/Src/siphash.d \
 ./Core/Src/speck.d \
+./Core/Src/speck_keys.d \
 ./Core/Src/stm32f4xx_hal_msp.d \
 ./Core/Src/stm32f4xx_it.d \
 ./Core/Src/syscalls.d \
 ./Core/Src/sysmem.d \
-./Core/Src/system_stm32f4xx.d 
+./Core/Src/system_stm32f4xx.d \
+./Core/Src/test_data.d 
 
 
 # Each subdirectory must supply rules for building sources it contributes
@@ -42,7 +66,7 @@ Core/Src/%.o Core/Src/%.su Core/Src/%.cyclo: ../Core/Src/%.c Core/Src/subdir.mk
 clean: clean-Core-2f-Src
 
 clean-Core-2f-Src:
-	-$(RM) ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/secure_uart.cyclo ./Core/Src/secure_uart.d ./Core/Src/secure_uart.o ./Core/Src/secure_uart.su ./Core/Src/speck.cyclo ./Core/Src/speck.d ./Core/Src/speck.o ./Core/Src/speck.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su
+	-$(RM) ./Core/Src/cnt_store.cyclo ./Core/Src/cnt_store.d ./Core/Src/cnt_store.o ./Core/Src/cnt_store.su ./Core/Src/crc_engine.cyclo ./Core/Src/crc_engine.d ./Core/Src/crc_engine.o ./Core/Src/crc_engine.su ./Core/Src/halfsiphash.cyclo ./Core/Src/halfsiphash.d ./Core/Src/halfsiphash.o ./Core/Src/halfsiphash.su ./Core/Src/lzss.cyclo ./Core/Src/lzss.d ./Core/Src/lzss.o ./Core/Src/lzss.su ./Core/Src/mac_bench.cyclo ./Core/Src/mac_bench.d ./Core/Src/mac_bench.o ./Core/Src/mac_bench.su ./Core/Src/main.cyclo ./Core/Src/main.d ./Core/Src/main.o ./Core/Src/main.su ./Core/Src/secure_uart.cyclo ./Core/Src/secure_uart.d ./Core/Src/secure_uart.o ./Core/Src/secure_uart.su ./Core/Src/siphash.cyclo ./Core/Src/siphash.d ./Core/Src/siphash.o ./Core/Src/siphash.su ./Core/Src/speck.cyclo ./Core/Src/speck.d ./Core/Src/speck.o ./Core/Src/speck.su ./Core/Src/speck_keys.cyclo ./Core/Src/speck_keys.d ./Core/Src/speck_keys.o ./Core/Src/speck_keys.su ./Core/Src/stm32f4xx_hal_msp.cyclo ./Core/Src/stm32f4xx_hal_msp.d ./Core/Src/stm32f4xx_hal_msp.o ./Core/Src/stm32f4xx_hal_msp.su ./Core/Src/stm32f4xx_it.cyclo ./Core/Src/stm32f4xx_it.d ./Core/Src/stm32f4xx_it.o ./Core/Src/stm32f4xx_it.su ./Core/Src/syscalls.cyclo ./Core/Src/syscalls.d ./Core/Src/syscalls.o ./Core/Src/syscalls.su ./Core/Src/sysmem.cyclo ./Core/Src/sysmem.d ./Core/Src/sysmem.o ./Core/Src/sysmem.su ./Core/Src/system_stm32f4xx.cyclo ./Core/Src/system_stm32f4xx.d ./Core/Src/system_stm32f4xx.o ./Core/Src/system_stm32f4xx.su ./Core/Src/test_data.cyclo ./Core/Src/test_data.d ./Core/Src/test_data.o ./Core/Src/test_data.su
 
 .PHONY: clean-Core-2f-Src
 
@@ -0,0 +1,195 @@
+/**
+ * @file speck_bench.c
+ * @brief Сверка ядер Speck прошивки с компактным циклом и замер тактов на байт
+ *
+ * На сообщениях test_dataXS..XL из прошивки сравнивает speck_encrypt,
+ * speck_decrypt и speck_mac сборки (развернутые ядра; MAC всегда считается
+ * циклом) с ядрами SPECK_UNROLLED = 0 (Tools/speck_ref.c) и с
+ * опубликованным вектором Speck64/128, затем печатает время на байт обоих
+ * вариантов. Такты хоста (TSC) показывают только соотношение; абсолютные
+ * числа для Cortex-M4 дает DWT в прошивке.
+ * Код возврата 0 - все сверки прошли.
+ *
+ * Развернутые ядра на хосте:
+ *   cc -O2 -DSPECK_UNROLLED=1 -I../Core/Inc speck_bench.c speck_ref.c ../Core/Src/speck.c \
+ *       ../Core/Src/test_data.c -o speck_bench
+ *   ./speck_bench
+ */
+
+#include "speck.h"
+#include "test_data.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static uint64_t bench_now(void) {
+    return __rdtsc();
+}
+#else
+// Не x86: только clock()
+#define BENCH_UNIT "ns"
+static uint64_t bench_now(void) {
+    return (uint64_t)clock() * (1000000000u / CLOCKS_PER_SEC);
+}
+#endif
+
+#if !SPECK_UNROLLED
+#error "speck_bench сравнивает развернутые ядра с циклом: собирать с -DSPECK_UNROLLED=1"
+#endif
+#define BENCH_KERNEL "unrolled"
+
+#define BENCH_PASSES  2000         // Проходов по сообщению за замер
+#define BENCH_RUNS    9            // Замеров, берется лучший
+
+// Ядра компактного цикла (Tools/speck_ref.c)
+void speck_init_ref(SpeckContext *ctx, const uint32_t *key);
+void speck_encrypt_ref(const SpeckContext *ctx, uint32_t *block);
+void speck_decrypt_ref(const SpeckContext *ctx, uint32_t *block);
+void speck_mac_ref(const SpeckContext *ctx, const uint8_t *data, size_t len, uint8_t *mac);
+
+typedef void (*BlockFn)(const SpeckContext *ctx, uint32_t *block);
+typedef void (*MacFn)(const SpeckContext *ctx, const uint8_t *data, size_t len, uint8_t *mac);
+
+static const struct {
+    const char *name;
+    const uint8_t *data;
+    size_t len;
+} sets[] = {
+    { "XS", test_dataXS, sizeof(test_dataXS) },
+    { "S",  test_dataS,  sizeof(test_dataS) },
+    { "M",  test_dataM,  sizeof(test_dataM) },
+    { "L",  test_dataL,  sizeof(test_dataL) },
+    { "XL", test_dataXL, sizeof(test_dataXL) },
+};
+
+#define SET_COUNT  (sizeof(sets) / sizeof(sets[0]))
+
+static int failures = 0;
+
+static void fail(const char *what, const char *set, size_t block) {
+    printf("FAIL %s %s block %u\n", what, set, (unsigned)block);
+    failures++;
+}
+
+/**
+ * @brief Такты на байт шифрования сообщения поблочно (лучший из BENCH_RUNS)
+ */
+static double bench_encrypt(BlockFn fn, const SpeckContext *ctx, const uint8_t *data, size_t len) {
+    uint64_t best = UINT64_MAX;
+
+    for (int r = 0; r < BENCH_RUNS; r++) {
+        uint64_t t0 = bench_now();
+        for (int p = 0; p < BENCH_PASSES; p++) {
+            for (size_t i = 0; i < len; i += 8) {
+                uint32_t block[2];
+                memcpy(block, data + i, sizeof(block));
+                fn(ctx, block);
+                __asm__ volatile("" : : "r"(block[0]), "r"(block[1]));
+            }
+        }
+        uint64_t t = bench_now() - t0;
+        if (t < best) {
+            best = t;
+        }
+    }
+
+    return (double)best / ((double)BENCH_PASSES * len);
+}
+
+/**
+ * @brief Такты на байт MAC сообщения (лучший из BENCH_RUNS)
+ */
+static double bench_mac(MacFn fn, const SpeckContext *ctx, const uint8_t *data, size_t len) {
+    uint64_t best = UINT64_MAX;
+    uint8_t mac[8];
+
+    for (int r = 0; r < BENCH_RUNS; r++) {
+        uint64_t t0 = bench_now();
+        for (int p = 0; p < BENCH_PASSES; p++) {
+            fn(ctx, data, len, mac);
+            __asm__ volatile("" : : "r"(mac) : "memory");
+        }
+        uint64_t t = bench_now() - t0;
+        if (t < best) {
+            best = t;
+        }
+    }
+
+    return (double)best / ((double)BENCH_PASSES * len);
+}
+
+int main(void) {
+    // Ключ прошивки (Core/Src/speck_keys.c)
+    static const uint32_t key[4] = { 0x0F0E0D0C, 0x0B0A0908, 0x07060504, 0x03020100 };
+    // Опубликованный вектор Speck64/128: ключ k0 l0 l1 l2, блок x y
+    static const uint32_t vector_key[4] = { 0x03020100, 0x0B0A0908, 0x13121110, 0x1B1A1918 };
+    static const uint32_t vector_plain[2] = { 0x3B726574, 0x7475432D };
+    static const uint32_t vector_cipher[2] = { 0x8C6FA548, 0x454E028B };
+    SpeckContext ctx, ref;
+    uint32_t block[2];
+
+    speck_init(&ctx, vector_key);
+    memcpy(block, vector_plain, sizeof(block));
+    speck_encrypt(&ctx, block);
+    if (memcmp(block, vector_cipher, sizeof(block)) != 0) {
+        fail("vector encrypt", "-", 0);
+    }
+    speck_decrypt(&ctx, block);
+    if (memcmp(block, vector_plain, sizeof(block)) != 0) {
+        fail("vector decrypt", "-", 0);
+    }
+
+    speck_init(&ctx, key);
+    speck_init_ref(&ref, key);
+    if (memcmp(&ctx, &ref, sizeof(ctx)) != 0) {
+        fail("key schedule", "-", 0);
+    }
+
+    for (size_t s = 0; s < SET_COUNT; s++) {
+        uint8_t mac[8], mac_ref[8];
+
+        for (size_t i = 0; i < sets[s].len; i += 8) {
+            uint32_t a[2], b[2];
+
+            memcpy(a, sets[s].data + i, sizeof(a));
+            memcpy(b, a, sizeof(b));
+            speck_encrypt(&ctx, a);
+            speck_encrypt_ref(&ref, b);
+            if (memcmp(a, b, sizeof(a)) != 0) {
+                fail("encrypt", sets[s].name, i / 8);
+            }
+
+            speck_decrypt(&ctx, a);
+            speck_decrypt_ref(&ref, b);
+            if (memcmp(a, sets[s].data + i, sizeof(a)) != 0 || memcmp(b, a, sizeof(b)) != 0) {
+                fail("decrypt", sets[s].name, i / 8);
+            }
+        }
+
+        // Все длины от 0 до полного сообщения: неполные блоки MAC тоже
+        for (size_t len = 0; len <= sets[s].len; len++) {
+            speck_mac(&ctx, sets[s].data, len, mac);
+            speck_mac_ref(&ref, sets[s].data, len, mac_ref);
+            if (memcmp(mac, mac_ref, sizeof(mac)) != 0) {
+                fail("mac", sets[s].name, len);
+            }
+        }
+    }
+
+    printf("%s\n\n", failures ? "FAILED" : BENCH_KERNEL " == loop on test_dataXS..XL");
+
+    printf("set   bytes  encrypt %s/B       mac %s/B\n", BENCH_UNIT, BENCH_UNIT);
+    printf("                loop  %8s     loop  %8s\n", BENCH_KERNEL, BENCH_KERNEL);
+    for (size_t s = 0; s < SET_COUNT; s++) {
+        printf("%-4s %6u  %6.2f  %8.2f   %6.2f  %8.2f\n", sets[s].name, (unsigned)sets[s].len,
+               bench_encrypt(speck_encrypt_ref, &ref, sets[s].data, sets[s].len),
+               bench_encrypt(speck_encrypt, &ctx, sets[s].data, sets[s].len),
+               bench_mac(speck_mac_ref, &ref, sets[s].data, sets[s].len),
+               bench_mac(speck_mac, &ctx, sets[s].data, sets[s].len));
+    }
+
+    return failures ? 1 : 0;
+}
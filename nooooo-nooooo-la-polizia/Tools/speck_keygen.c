@@ -0,0 +1,63 @@
+/**
+ * @file speck_keygen.c
+ * @brief Генератор таблицы раундовых ключей Speck64/128 для прошивки (хост)
+ *
+ * Разворачивает ключ тем же speck_init, что и прошивка, и печатает
+ * Core/Src/speck_keys.c: контекст и таблицу в порядке расшифрования,
+ * которые компоновщик кладет во flash. Запускается как шаг pre-build
+ * при смене ключа:
+ *
+ *   cc -I../Core/Inc speck_keygen.c ../Core/Src/speck.c -o speck_keygen
+ *   ./speck_keygen 0F0E0D0C 0B0A0908 07060504 03020100 > ../Core/Src/speck_keys.c
+ */
+
+#include "speck.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void print_table(const uint32_t *keys, const char *indent) {
+    for (int i = 0; i < 27; i++) {
+        printf("%s0x%08lX,%s", (i % 4 == 0) ? indent : " ",
+                (unsigned long)keys[i], (i % 4 == 3 || i == 26) ? "\n" : "");
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t key[4];
+    uint32_t dec[27];
+    SpeckContext ctx;
+
+    if (argc != 5) {
+        fprintf(stderr, "usage: %s <k0> <k1> <k2> <k3>  (32-bit words, hex)\n", argv[0]);
+        return 2;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        key[i] = (uint32_t)strtoul(argv[i + 1], NULL, 16);
+    }
+
+    speck_init(&ctx, key);
+    for (int i = 0; i < 27; i++) {
+        dec[i] = ctx.round_keys[26 - i];
+    }
+
+    printf("/**\n");
+    printf(" * @file speck_keys.c\n");
+    printf(" * @brief Раундовые ключи Speck64/128, развернутые при сборке\n");
+    printf(" * @note Сгенерировано Tools/speck_keygen, не редактировать вручную\n");
+    printf(" */\n\n");
+    printf("#include \"speck_keys.h\"\n\n");
+    printf("// Ключ 0x%08lX 0x%08lX 0x%08lX 0x%08lX\n",
+            (unsigned long)key[0], (unsigned long)key[1], (unsigned long)key[2], (unsigned long)key[3]);
+    printf("const SpeckContext secure_key_ctx = {\n");
+    printf("\t.round_keys = {\n");
+    print_table(ctx.round_keys, "\t\t");
+    printf("\t}\n");
+    printf("};\n\n");
+    printf("// Те же ключи в порядке расшифрования: secure_key_dec[i] = round_keys[26 - i]\n");
+    printf("const uint32_t secure_key_dec[27] = {\n");
+    print_table(dec, "\t");
+    printf("};\n");
+
+    return 0;
+}
@@ -0,0 +1,21 @@
+/**
+ * @file speck_ref.c
+ * @brief Компактные ядра Speck (SPECK_UNROLLED = 0) под именами *_ref для Tools/speck_bench
+ *
+ * Тот же Core/Src/speck.c, собранный второй раз с циклом раундов, чтобы
+ * развернутые ядра сверялись с ним в одной программе.
+ */
+
+#undef SPECK_UNROLLED
+#define SPECK_UNROLLED 0
+
+#define speck_init speck_init_ref
+#define speck_encrypt speck_encrypt_ref
+#define speck_decrypt speck_decrypt_ref
+#define speck_mac speck_mac_ref
+#define speck_mac_blocks speck_mac_blocks_ref
+#define speck_mac_init speck_mac_init_ref
+#define speck_mac_update speck_mac_update_ref
+#define speck_mac_final speck_mac_final_ref
+
+#include "../Core/Src/speck.c"
@@ -0,0 +1,286 @@
+/**
+ * @file crc_engine.c
+ * @brief Движки контроля целостности фрейма: CRC16 побитно, CRC16 по таблицам, CRC32 блока CRC
+ */
+
+#include "crc_engine.h"
+#include <stddef.h>
+
+#if defined(__arm__)
+#include <stdio.h>
+#include <string.h>
+#endif
+
+// Таблицы slicing-by-N: crc16_table[0] - обычная побайтовая таблица,
+// crc16_table[k][n] - вклад байта n, за которым идут еще k байт
+static uint16_t crc16_table[CRC16_SLICES][256];
+
+#if defined(__arm__)
+// Регистры блока CRC
+#define CRC_HW_RESET()       (CRC->CR = CRC_CR_RESET)
+#define CRC_HW_FEED(word)    (CRC->DR = (word))
+#define CRC_HW_RESULT()      (CRC->DR)
+
+#if CRC_ENGINE_HW_DMA
+static DMA_HandleTypeDef hdma_crc;   // DMA2_Stream0: слова из памяти в CRC->DR
+#endif
+#else
+// Программная модель блока CRC для проверки на хосте: CRC-32/MPEG-2,
+// начальное значение 0xFFFFFFFF, слово сдвигается старшим битом вперед
+static uint32_t crc_model_dr;
+
+static void CrcModel_Feed(uint32_t word) {
+    crc_model_dr ^= word;
+    for (uint8_t j = 0; j < 32; j++) {
+        if (crc_model_dr & 0x80000000u) {
+            crc_model_dr = (crc_model_dr << 1) ^ 0x04C11DB7u;
+        } else {
+            crc_model_dr = crc_model_dr << 1;
+        }
+    }
+}
+
+#define CRC_HW_RESET()       (crc_model_dr = 0xFFFFFFFFu)
+#define CRC_HW_FEED(word)    CrcModel_Feed(word)
+#define CRC_HW_RESULT()      (crc_model_dr)
+#endif
+
+/**
+ * @brief Построение таблиц CRC16 и включение блока CRC
+ */
+void CrcEngine_Init(void) {
+    for (uint16_t n = 0; n < 256; n++) {
+        uint16_t crc = n;
+        for (uint8_t j = 0; j < 8; j++) {
+            if (crc & 0x0001) {
+                crc = (crc >> 1) ^ 0xA001; // Полином 0x8005 в отраженном виде
+            } else {
+                crc = crc >> 1;
+            }
+        }
+        crc16_table[0][n] = crc;
+    }
+
+    for (uint16_t n = 0; n < 256; n++) {
+        for (uint8_t k = 1; k < CRC16_SLICES; k++) {
+            uint16_t prev = crc16_table[k - 1][n];
+            crc16_table[k][n] = (prev >> 8) ^ crc16_table[0][prev & 0xFF];
+        }
+    }
+
+#if defined(__arm__)
+    __HAL_RCC_CRC_CLK_ENABLE();
+
+#if CRC_ENGINE_HW_DMA
+    // Память -> память: источник (порт "периферии") растет, приемник - CRC->DR
+    __HAL_RCC_DMA2_CLK_ENABLE();
+    hdma_crc.Instance = DMA2_Stream0;
+    hdma_crc.Init.Channel = DMA_CHANNEL_0;
+    hdma_crc.Init.Direction = DMA_MEMORY_TO_MEMORY;
+    hdma_crc.Init.PeriphInc = DMA_PINC_ENABLE;
+    hdma_crc.Init.MemInc = DMA_MINC_DISABLE;
+    hdma_crc.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma_crc.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdma_crc.Init.Mode = DMA_NORMAL;
+    hdma_crc.Init.Priority = DMA_PRIORITY_LOW;
+    hdma_crc.Init.FIFOMode = DMA_FIFOMODE_ENABLE;
+    hdma_crc.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+    hdma_crc.Init.MemBurst = DMA_MBURST_SINGLE;
+    hdma_crc.Init.PeriphBurst = DMA_PBURST_SINGLE;
+    HAL_DMA_Init(&hdma_crc);
+#endif
+#endif
+}
+
+/**
+ * @brief CRC-16/MODBUS побитно
+ */
+uint16_t Crc16_Bitwise(const uint8_t *data, uint16_t length) {
+    uint16_t crc = 0xFFFF;
+
+    for (uint16_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i];
+        for (uint8_t j = 0; j < 8; j++) {
+            if (crc & 0x0001) {
+                crc = (crc >> 1) ^ 0xA001;
+            } else {
+                crc = crc >> 1;
+            }
+        }
+    }
+
+    return crc;
+}
+
+/**
+ * @brief CRC-16/MODBUS по таблицам
+ */
+uint16_t Crc16_Sliced(const uint8_t *data, uint16_t length) {
+    return Crc16_SlicedUpdate(0xFFFF, data, length);
+}
+
+/**
+ * @brief Продолжение CRC-16/MODBUS по таблицам
+ * @note CRC короче шага, поэтому с состоянием смешиваются только два первых
+ *       байта шага, остальные байты идут в таблицы напрямую
+ */
+uint16_t Crc16_SlicedUpdate(uint16_t crc, const uint8_t *data, uint16_t length) {
+    while (length >= CRC16_SLICES) {
+        uint8_t b0 = data[0] ^ (crc & 0xFF);
+        uint8_t b1 = data[1] ^ (crc >> 8);
+
+#if CRC16_SLICES == 8
+        crc = crc16_table[7][b0] ^ crc16_table[6][b1] ^
+              crc16_table[5][data[2]] ^ crc16_table[4][data[3]] ^
+              crc16_table[3][data[4]] ^ crc16_table[2][data[5]] ^
+              crc16_table[1][data[6]] ^ crc16_table[0][data[7]];
+#else
+        crc = crc16_table[3][b0] ^ crc16_table[2][b1] ^
+              crc16_table[1][data[2]] ^ crc16_table[0][data[3]];
+#endif
+
+        data += CRC16_SLICES;
+        length -= CRC16_SLICES;
+    }
+
+    // Хвост короче шага - по одному байту
+    while (length--) {
+        crc = (crc >> 8) ^ crc16_table[0][(crc ^ *data++) & 0xFF];
+    }
+
+    return crc;
+}
+
+/**
+ * @brief Подача данных в блок CRC словами little-endian
+ * @param use_dma Передать полные слова через DMA2_Stream0 (данные выровнены на 4)
+ */
+static uint32_t Crc32_HwFeed(const uint8_t *data, uint16_t length, int use_dma) {
+    uint16_t i = 0;
+
+#if defined(__arm__)
+    // Блок CRC один на всех: расчет из прерывания приема не должен вклиниться
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+#endif
+
+    CRC_HW_RESET();
+
+#if defined(__arm__) && CRC_ENGINE_HW_DMA
+    if (use_dma && length >= 4) {
+        uint16_t words = length / 4;
+        HAL_DMA_Start(&hdma_crc, (uint32_t)data, (uint32_t)&CRC->DR, words);
+        HAL_DMA_PollForTransfer(&hdma_crc, HAL_DMA_FULL_TRANSFER, 10);
+        i = words * 4;
+    }
+#else
+    (void)use_dma;
+#endif
+
+    for (; i + 4 <= length; i += 4) {
+        CRC_HW_FEED((uint32_t)data[i] |
+                    ((uint32_t)data[i + 1] << 8) |
+                    ((uint32_t)data[i + 2] << 16) |
+                    ((uint32_t)data[i + 3] << 24));
+    }
+
+    // Хвост дополняется нулями до слова
+    if (i < length) {
+        uint32_t tail = 0;
+        for (uint8_t k = 0; i + k < length; k++) {
+            tail |= (uint32_t)data[i + k] << (8 * k);
+        }
+        CRC_HW_FEED(tail);
+    }
+
+    uint32_t crc = CRC_HW_RESULT();
+
+#if defined(__arm__)
+    __set_PRIMASK(primask);
+#endif
+
+    return crc;
+}
+
+/**
+ * @brief CRC-32/MPEG-2 блоком CRC
+ */
+uint32_t Crc32_Hw(const uint8_t *data, uint16_t length) {
+    // DMA выгоден только на длинных выровненных буферах
+    int use_dma = CRC_ENGINE_HW_DMA && length >= CRC_ENGINE_DMA_MIN &&
+                  ((uintptr_t)data & 3) == 0;
+
+    return Crc32_HwFeed(data, length, use_dma);
+}
+
+/**
+ * @brief CRC выбранного движка
+ */
+uint32_t CrcEngine_Compute(const uint8_t *data, uint16_t length) {
+#if CRC_ENGINE == CRC_ENGINE_HW32
+    return Crc32_Hw(data, length);
+#elif CRC_ENGINE == CRC_ENGINE_SLICED
+    return Crc16_Sliced(data, length);
+#else
+    return Crc16_Bitwise(data, length);
+#endif
+}
+
+#if defined(__arm__)
+/**
+ * @brief Строка замера: такты на байт с двумя знаками после запятой
+ */
+static void CrcEngine_PrintRate(UART_HandleTypeDef *huart, const char *name, uint32_t cycles, uint16_t length) {
+    char line[64];
+
+    snprintf(line, sizeof(line), "  %s %lu.%02lu\r\n", name,
+             cycles / length, (cycles * 100 / length) % 100);
+    HAL_UART_Transmit(huart, (uint8_t *)line, strlen(line), 100);
+}
+
+/**
+ * @brief Замер тактов DWT на байт для всех движков
+ */
+void CrcEngine_Benchmark(UART_HandleTypeDef *huart) {
+    char line[64];
+    static uint32_t buffer_words[64];            // 256 байт, выровнено для DMA
+    const uint8_t *buffer = (const uint8_t *)buffer_words;
+    const uint16_t length = sizeof(buffer_words);
+    uint32_t cycles[4];
+    volatile uint32_t sink;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for (uint16_t i = 0; i < 64; i++) {
+        buffer_words[i] = 0x9E3779B9u * (i + 1);
+    }
+
+    uint32_t t0 = DWT->CYCCNT;
+    sink = Crc16_Bitwise(buffer, length);
+    cycles[0] = DWT->CYCCNT - t0;
+
+    t0 = DWT->CYCCNT;
+    sink = Crc16_Sliced(buffer, length);
+    cycles[1] = DWT->CYCCNT - t0;
+
+    t0 = DWT->CYCCNT;
+    sink = Crc32_HwFeed(buffer, length, 0);
+    cycles[2] = DWT->CYCCNT - t0;
+
+    t0 = DWT->CYCCNT;
+    sink = Crc32_HwFeed(buffer, length, 1);
+    cycles[3] = DWT->CYCCNT - t0;
+    (void)sink;
+
+    // Вывод прямо в UART: движок собирается в обе прошивки, и у каждой свой журнал
+    snprintf(line, sizeof(line), "CRC, тактов/байт (%u байт):\r\n", length);
+    HAL_UART_Transmit(huart, (uint8_t *)line, strlen(line), 100);
+    CrcEngine_PrintRate(huart, "CRC16 побитно:     ", cycles[0], length);
+    CrcEngine_PrintRate(huart, CRC16_SLICES == 8 ? "CRC16 slicing-by-8:" : "CRC16 slicing-by-4:", cycles[1], length);
+    CrcEngine_PrintRate(huart, "CRC32 блок CRC:    ", cycles[2], length);
+#if CRC_ENGINE_HW_DMA
+    CrcEngine_PrintRate(huart, "CRC32 блок CRC+DMA:", cycles[3], length);
+#endif
+}
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file crc_engine.h
+ * @brief Движки контроля целостности фрейма: CRC16 побитно, CRC16 по таблицам, CRC32 блока CRC
+ */
+
+#ifndef CRC_ENGINE_H
+#define CRC_ENGINE_H
+
+#include <stdint.h>
+
+#if defined(__arm__)
+#include "main.h"
+#endif
+
+// Движок, которым защищаются фреймы
+#define CRC_ENGINE_BITWISE   0   // CRC-16/MODBUS, 8 итераций на байт (исходный вариант)
+#define CRC_ENGINE_SLICED    1   // CRC-16/MODBUS, slicing-by-N по таблицам
+#define CRC_ENGINE_HW32      2   // CRC-32/MPEG-2 на периферии CRC STM32F411
+
+#ifndef CRC_ENGINE
+#define CRC_ENGINE           CRC_ENGINE_SLICED
+#endif
+
+#ifndef CRC16_SLICES
+#define CRC16_SLICES         8   // 4 или 8 байт за шаг (таблицы 2 или 4 КБ в RAM)
+#endif
+
+#ifndef CRC_ENGINE_HW_DMA
+#define CRC_ENGINE_HW_DMA    1   // 1 - слова в CRC->DR подает DMA2_Stream0 (память -> память)
+#endif
+#define CRC_ENGINE_DMA_MIN   64  // Короче - быстрее записать CPU, чем настраивать DMA
+
+#define CRC_ENGINE_BENCH     0   // 1 - замер тактов на байт при старте
+
+// Размер поля CRC во фрейме для выбранного движка
+#if CRC_ENGINE == CRC_ENGINE_HW32
+#define CRC_ENGINE_SIZE      4
+#else
+#define CRC_ENGINE_SIZE      2
+#endif
+
+#if CRC16_SLICES != 4 && CRC16_SLICES != 8
+#error "CRC16_SLICES must be 4 or 8"
+#endif
+
+/**
+ * @brief Построение таблиц CRC16 и включение блока CRC (и его DMA)
+ * @note Вызывать один раз до первого расчета CRC
+ */
+void CrcEngine_Init(void);
+
+/**
+ * @brief CRC-16/MODBUS побитно
+ * @param data Указатель на данные
+ * @param length Длина данных
+ * @return Значение CRC16
+ */
+uint16_t Crc16_Bitwise(const uint8_t *data, uint16_t length);
+
+/**
+ * @brief CRC-16/MODBUS по таблицам, CRC16_SLICES байт за шаг
+ * @param data Указатель на данные
+ * @param length Длина данных
+ * @return Значение CRC16 (совпадает с Crc16_Bitwise)
+ */
+uint16_t Crc16_Sliced(const uint8_t *data, uint16_t length);
+
+/**
+ * @brief Продолжение CRC-16/MODBUS по таблицам для данных, идущих частями
+ * @param crc CRC предыдущих частей (0xFFFF перед первой)
+ * @param data Указатель на данные
+ * @param length Длина данных
+ * @return CRC с учетом этой части
+ */
+uint16_t Crc16_SlicedUpdate(uint16_t crc, const uint8_t *data, uint16_t length);
+
+/**
+ * @brief CRC-32/MPEG-2 блоком CRC (на хосте - его программной моделью)
+ * @note Блок принимает только 32-битные слова: данные читаются словами
+ *       little-endian, хвост короче слова дополняется нулями
+ * @param data Указатель на данные
+ * @param length Длина данных
+ * @return Значение CRC32
+ */
+uint32_t Crc32_Hw(const uint8_t *data, uint16_t length);
+
+/**
+ * @brief CRC выбранного движка (CRC_ENGINE_SIZE младших байт значимы)
+ * @param data Указатель на данные
+ * @param length Длина данных
+ * @return Значение CRC
+ */
+uint32_t CrcEngine_Compute(const uint8_t *data, uint16_t length);
+
+#if defined(__arm__)
+/**
+ * @brief Замер тактов DWT на байт для всех движков, вывод в отладочный UART
+ * @param huart Дескриптор UART для отладки
+ */
+void CrcEngine_Benchmark(UART_HandleTypeDef *huart);
+#endif
+
+#endif // CRC_ENGINE_H
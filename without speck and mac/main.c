@@ -12,6 +12,7 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "secure_uart.h"
+#include "crc_engine.h"
 #include <string.h>
 /* USER CODE END Includes */
 
@@ -110,6 +111,12 @@ int main(void)
   MX_USART6_UART_Init();
   /* USER CODE BEGIN 2 */
 
+    // Таблицы CRC16 и блок CRC - до первого фрейма
+    CrcEngine_Init();
+#if CRC_ENGINE_BENCH
+    CrcEngine_Benchmark(&huart2);
+#endif
+
     // Инициализация контекстов защищенного UART
     SecureUart_Init(&TxContext, &huart1, &huart2);
     SecureUart_Init(&RxContext, &huart6, &huart2);
@@ -4,9 +4,15 @@
  */
 
 #include "secure_uart.h"
+#include "crc_engine.h"
 #include <stdio.h>
 #include <stdarg.h>
 
+// Размеры в secure_uart.h рассчитаны на CRC16; CRC32 занимает во фрейме
+// на CRC_EXTRA_SIZE байт больше за счет полезных данных
+#define CRC_EXTRA_SIZE     (CRC_ENGINE_SIZE - CRC_SIZE)
+#define MAX_PAYLOAD_SIZE   (MAX_DATA_SIZE - CRC_EXTRA_SIZE)
+
 // Глобальный счетчик для последовательных номеров
 static uint32_t g_sequence_counter = 0;
 
@@ -48,7 +54,7 @@ void SecureUart_StartReceive(SecureUartContext *ctx) {
  * @return Статус операции
  */
 SecureUartStatus SecureUart_Send(SecureUartContext *ctx, const uint8_t *data, uint8_t length) {
-    if (length > MAX_DATA_SIZE) {
+    if (length > MAX_PAYLOAD_SIZE) {
         SecureUart_DebugPrint(ctx->debug_uart, "Ошибка: превышен максимальный размер данных\r\n");
         return SECURE_UART_BUFFER_OVERFLOW;
     }
@@ -79,9 +85,9 @@ SecureUartStatus SecureUart_Send(SecureUartContext *ctx, const uint8_t *data, ui
     }
 
     // Расчет и добавление CRC
-    uint16_t crc = SecureUart_CalculateCRC(frame, frame_pos);
-    memcpy(frame + frame_pos, &crc, CRC_SIZE);
-    frame_pos += CRC_SIZE;
+    uint32_t crc = CrcEngine_Compute(frame, frame_pos);
+    memcpy(frame + frame_pos, &crc, CRC_ENGINE_SIZE);
+    frame_pos += CRC_ENGINE_SIZE;
 
     // Отладочный вывод
     SecureUart_DebugPrint(ctx->debug_uart, "Отправка фрейма (seq_id=%lu, длина=%u):\r\n", seq_id, length);
@@ -107,7 +113,7 @@ SecureUartStatus SecureUart_ProcessReceivedData(SecureUartContext *ctx, SecureUa
     uint16_t frame_size = ctx->rx_pos;
 
     // Проверка минимального размера фрейма
-    if (frame_size < MIN_FRAME_SIZE) {
+    if (frame_size < MIN_FRAME_SIZE + CRC_EXTRA_SIZE) {
         SecureUart_DebugPrint(ctx->debug_uart, "Ошибка: недостаточный размер фрейма (%u)\r\n", frame_size);
         return SECURE_UART_INVALID_FRAME;
     }
@@ -138,13 +144,13 @@ SecureUartStatus SecureUart_ProcessReceivedData(SecureUartContext *ctx, SecureUa
     uint8_t data_length = ctx->rx_buffer[FRAME_HEADER_SIZE + SEQUENCE_ID_SIZE];
 
     // Проверка корректности длины данных
-    if (data_length > MAX_DATA_SIZE) {
+    if (data_length > MAX_PAYLOAD_SIZE) {
         SecureUart_DebugPrint(ctx->debug_uart, "Ошибка: некорректная длина данных (%u)\r\n", data_length);
         return SECURE_UART_INVALID_FRAME;
     }
 
     // Проверка полного размера фрейма
-    uint16_t expected_frame_size = MIN_FRAME_SIZE + data_length;
+    uint16_t expected_frame_size = MIN_FRAME_SIZE + CRC_EXTRA_SIZE + data_length;
     if (frame_size < expected_frame_size) {
         SecureUart_DebugPrint(ctx->debug_uart, "Ошибка: неполный фрейм (ожидалось %u, получено %u)\r\n",
                               expected_frame_size, frame_size);
@@ -152,12 +158,12 @@ SecureUartStatus SecureUart_ProcessReceivedData(SecureUartContext *ctx, SecureUa
     }
 
     // Проверка CRC
-    uint16_t received_crc;
-    memcpy(&received_crc, ctx->rx_buffer + FRAME_HEADER_SIZE + SEQUENCE_ID_SIZE + 1 + data_length, CRC_SIZE);
+    uint32_t received_crc = 0;
+    memcpy(&received_crc, ctx->rx_buffer + FRAME_HEADER_SIZE + SEQUENCE_ID_SIZE + 1 + data_length, CRC_ENGINE_SIZE);
 
-    uint16_t calculated_crc = SecureUart_CalculateCRC(ctx->rx_buffer, FRAME_HEADER_SIZE + SEQUENCE_ID_SIZE + 1 + data_length);
+    uint32_t calculated_crc = CrcEngine_Compute(ctx->rx_buffer, FRAME_HEADER_SIZE + SEQUENCE_ID_SIZE + 1 + data_length);
     if (received_crc != calculated_crc) {
-        SecureUart_DebugPrint(ctx->debug_uart, "Ошибка CRC (получено 0x%04X, рассчитано 0x%04X)\r\n",
+        SecureUart_DebugPrint(ctx->debug_uart, "Ошибка CRC (получено 0x%08lX, рассчитано 0x%08lX)\r\n",
                               received_crc, calculated_crc);
         return SECURE_UART_CRC_ERROR;
     }
@@ -182,26 +188,13 @@ SecureUartStatus SecureUart_ProcessReceivedData(SecureUartContext *ctx, SecureUa
 }
 
 /**
- * @brief Простой расчет CRC16
+ * @brief Расчет CRC16 (CRC-16/MODBUS по таблицам, см. crc_engine.c)
  * @param data Указатель на данные
  * @param length Длина данных
  * @return Значение CRC16
  */
 uint16_t SecureUart_CalculateCRC(const uint8_t *data, uint16_t length) {
-    uint16_t crc = 0xFFFF;
-
-    for (uint16_t i = 0; i < length; i++) {
-        crc ^= (uint16_t)data[i];
-        for (uint8_t j = 0; j < 8; j++) {
-            if (crc & 0x0001) {
-                crc = (crc >> 1) ^ 0xA001; // Полином 0x8005 в отраженном виде
-            } else {
-                crc = crc >> 1;
-            }
-        }
-    }
-
-    return crc;
+    return Crc16_Sliced(data, length);
 }
 
 /**